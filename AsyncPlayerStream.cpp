@@ -0,0 +1,156 @@
+#include "AsyncPlayerStream.hpp"
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+void AsyncPlayerStream::recycle(PlayerBatch) {
+}
+
+AsyncStreamAdapter::AsyncStreamAdapter(PlayerStream& stream, const size_t& batch_size, const size_t& max_ready)
+    : stream_{stream}, batch_size_{batch_size}, max_ready_{max_ready}, pending_{false}, done_{false}, cancelled_{false} {
+    if (batch_size_ == 0 || max_ready_ == 0) {
+        throw std::invalid_argument("AsyncStreamAdapter needs a positive batch size & number of ready batches");
+    }
+    fetcher_ = std::thread(&AsyncStreamAdapter::fetch, this);
+}
+
+AsyncStreamAdapter::~AsyncStreamAdapter() {
+    cancel();
+    if (fetcher_.joinable()) {
+        fetcher_.join();
+    }
+}
+
+void AsyncStreamAdapter::fetch() {
+    while (true) {
+        PlayerBatch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            notFull_.wait(lock, [this] { return cancelled_ || ready_.size() < max_ready_; });
+            if (cancelled_) {
+                return;
+            }
+            if (!spare_.empty()) {
+                batch = std::move(spare_.back());
+                spare_.pop_back();
+            }
+        }
+
+        // Read without the lock, so the consumer can take ready batches meanwhile
+        std::exception_ptr error;
+        try {
+            const PlayerChunk chunk = stream_.nextChunk(batch_size_);
+            // Copy-assigning over a recycled batch's Players reuses their names' buffers
+            batch.assign(chunk.begin(), chunk.end());
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancelled_) {
+            return;
+        }
+        const bool last = error || batch.empty();
+        error_ = error;
+        if (pending_) {
+            pending_ = false;
+            if (error) {
+                waiting_.set_exception(error);
+            } else {
+                waiting_.set_value(std::move(batch));
+            }
+        } else if (!error) {
+            ready_.push_back(std::move(batch));
+        }
+        if (last) {
+            done_ = true;
+            return;
+        }
+    }
+}
+
+std::future<PlayerBatch> AsyncStreamAdapter::nextBatch() {
+    std::promise<PlayerBatch> promise;
+    std::future<PlayerBatch> future = promise.get_future();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_) {
+        throw std::logic_error("nextBatch() was called again before the previous batch arrived");
+    }
+    if (!ready_.empty()) {
+        promise.set_value(std::move(ready_.front()));
+        ready_.pop_front();
+        notFull_.notify_one();
+    } else if (error_) {
+        promise.set_exception(error_);
+    } else if (done_ || cancelled_) {
+        promise.set_value({});
+    } else {
+        waiting_ = std::move(promise);
+        pending_ = true;
+    }
+    return future;
+}
+
+void AsyncStreamAdapter::recycle(PlayerBatch batch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Enough to refill every ready slot, plus the one being read
+    if (spare_.size() <= max_ready_) {
+        spare_.push_back(std::move(batch));
+    }
+}
+
+void AsyncStreamAdapter::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cancelled_) {
+        return;
+    }
+    cancelled_ = true;
+    ready_.clear();
+    if (pending_) {
+        pending_ = false;
+        waiting_.set_value({});
+    }
+    notFull_.notify_all();
+}
+
+RankingResult Online::rankIncomingAsync(AsyncPlayerStream& stream, const size_t& reporting_interval) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    RankingMetrics fetched;
+    auto receive = [&fetched](std::future<PlayerBatch>& future) {
+        const auto w1 = std::chrono::high_resolution_clock::now();
+        PlayerBatch batch = future.get();
+        const auto w2 = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> time = w2 - w1;
+        // Any time spent here is time the batch was not ready yet
+        fetched.fetch_ms_ += time.count();
+        fetched.stall_ms_ += time.count();
+
+        if constexpr (METRICS_ENABLED) {
+            fetched.players_fetched_ += batch.size();
+            for (const Player& player : batch) {
+                fetched.bytes_fetched_ += sizeof(player.level_) + sizeof(player.id_) + player.name_.size();
+            }
+        }
+        return batch;
+    };
+
+    Leaderboard leaderboard(reporting_interval);
+    std::future<PlayerBatch> next = stream.nextBatch();
+    for (PlayerBatch batch = receive(next); !batch.empty(); batch = receive(next)) {
+        next = stream.nextBatch();
+        leaderboard.ingest(PlayerChunk{batch.data(), batch.data() + batch.size()});
+        stream.recycle(std::move(batch));
+    }
+    RankingResult result = leaderboard.finish();
+    result.metrics_.fetch_ms_ = fetched.fetch_ms_;
+    result.metrics_.stall_ms_ = fetched.stall_ms_;
+    result.metrics_.players_fetched_ = fetched.players_fetched_;
+    result.metrics_.bytes_fetched_ = fetched.bytes_fetched_;
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count() - result.metrics_.fetch_ms_;
+    return result;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "Leaderboard.hpp"
+#include "Player.hpp"
+#include "PlayerStream.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A batch of Players handed out by an AsyncPlayerStream, owned by the consumer.
+ */
+using PlayerBatch = std::vector<Player>;
+
+/**
+ * @brief Interface for fetching Players asynchronously, in batches.
+ *
+ * Unlike PlayerStream's chunks, a batch stays valid after the next one is requested,
+ * so a consumer can rank batch i while batch i + 1 is still in flight.
+ */
+class AsyncPlayerStream {
+public:
+    virtual ~AsyncPlayerStream() = default;
+
+    /**
+     * @brief Requests the next batch of Players.
+     *
+     * @return A future for the next batch, in stream order. The batch is empty once the
+     *      stream is exhausted or cancelled. If fetching failed, the future rethrows its exception.
+     * @throws std::logic_error If the previous request's future has not been fulfilled yet:
+     *      only one request may be outstanding at a time.
+     */
+    virtual std::future<PlayerBatch> nextBatch() = 0;
+
+    /**
+     * @brief Hands a consumed batch back, so its Players (& their names' buffers) can be reused.
+     * The default implementation simply drops it.
+     */
+    virtual void recycle(PlayerBatch batch);
+
+    /**
+     * @brief Stops fetching. Any outstanding & later requests yield an empty batch.
+     * Safe to call from any thread, & more than once.
+     */
+    virtual void cancel() = 0;
+};
+
+/**
+ * @brief Adapts a synchronous PlayerStream into an AsyncPlayerStream, so every existing stream
+ *        works with the asynchronous rankings.
+ *
+ * A background thread reads the stream in batches of up to `batch_size` Players, staying up to
+ * `max_ready` batches ahead of the consumer. Once that many are waiting, it blocks until one is
+ * taken, so a slow consumer holds at most max_ready batches in memory (backpressure).
+ *
+ * @note The wrapped stream must only be used through the adapter while it is alive.
+ */
+class AsyncStreamAdapter : public AsyncPlayerStream {
+private:
+    PlayerStream& stream_;
+    size_t batch_size_;
+    size_t max_ready_;
+
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+
+    /**
+     * @brief Fetched batches not yet requested, at most max_ready_ long.
+     */
+    std::deque<PlayerBatch> ready_;
+
+    /**
+     * @brief Recycled batches, reused by the fetching thread.
+     */
+    std::vector<PlayerBatch> spare_;
+
+    /**
+     * @brief The promise for a request made while ready_ was empty, if pending_ is set.
+     */
+    std::promise<PlayerBatch> waiting_;
+    bool pending_;
+
+    bool done_;
+    bool cancelled_;
+    std::exception_ptr error_;
+    std::thread fetcher_;
+
+    /**
+     * @brief The fetching thread's loop.
+     */
+    void fetch();
+
+public:
+    /**
+     * @brief Starts fetching from `stream` in the background.
+     *
+     * @param batch_size The largest number of Players per batch
+     * @param max_ready The number of fetched batches that may wait for the consumer
+     * @throws std::invalid_argument If batch_size or max_ready is 0.
+     */
+    explicit AsyncStreamAdapter(PlayerStream& stream, const size_t& batch_size = Online::CHUNK_SIZE, const size_t& max_ready = 2);
+
+    /**
+     * @brief Cancels, then waits for the fetching thread to finish its current read.
+     */
+    ~AsyncStreamAdapter() override;
+
+    AsyncStreamAdapter(const AsyncStreamAdapter&) = delete;
+    AsyncStreamAdapter& operator=(const AsyncStreamAdapter&) = delete;
+
+    std::future<PlayerBatch> nextBatch() override;
+    void recycle(PlayerBatch batch) override;
+    void cancel() override;
+};
+
+namespace Online {
+/**
+ * @brief rankIncoming() over an AsyncPlayerStream: requests batch i + 1 before ranking batch i,
+ *        so fetching overlaps the heap work instead of being serialized with it.
+ *
+ * Each batch is ingested into a Leaderboard, then recycled to the stream.
+ * If the stream is cancelled, ranks the Players received so far.
+ *
+ * @return A RankingResult as rankIncoming()'s. metrics_.fetch_ms_ & stall_ms_ hold the time spent
+ *      waiting on batches that were not yet ready, which elapsed_ leaves out.
+ * @throws Whatever the stream failed with, if fetching failed.
+ */
+RankingResult rankIncomingAsync(AsyncPlayerStream& stream, const size_t& reporting_interval);
+}; // namespace Online
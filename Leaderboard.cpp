@@ -1,17 +1,216 @@
 #include "Leaderboard.hpp"
+#include <cstdio>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
+
+CutoffSeries::CutoffSeries(const size_t &interval)
+    : interval_{interval}, tail_count_{0}, tail_level_{0} {
+}
+
+CutoffSeries::CutoffSeries(const std::unordered_map<size_t, size_t> &cutoffs)
+    : interval_{0}, tail_count_{0}, tail_level_{0} {
+    std::vector<std::pair<size_t, size_t>> entries(cutoffs.begin(), cutoffs.end());
+    std::sort(entries.begin(), entries.end());
+    if (entries.empty()) {
+        return;
+    }
+
+    interval_ = entries.front().first;
+    if (interval_ == 0) {
+        throw std::invalid_argument("Cutoffs cannot be recorded after 0 players.");
+    }
+    for (const auto &[count, level] : entries) {
+        record(count, level);
+    }
+}
+
+void CutoffSeries::record(const size_t &count, const size_t &level) {
+    if (tail_count_ == 0 && interval_ > 0 && count == (levels_.size() + 1) * interval_) {
+        levels_.push_back(level);
+    } else if (tail_count_ == 0 && interval_ > 0 && count > levels_.size() * interval_ && count < (levels_.size() + 1) * interval_) {
+        tail_count_ = count;
+        tail_level_ = level;
+    } else {
+        throw std::invalid_argument("Cutoff recorded out of order at count " + std::to_string(count));
+    }
+}
+
+size_t CutoffSeries::at(const size_t &count) const {
+    if (this->count(count) == 0) {
+        throw std::out_of_range("No cutoff recorded at count " + std::to_string(count));
+    }
+    return count == tail_count_ ? tail_level_ : levels_[count / interval_ - 1];
+}
+
+size_t CutoffSeries::count(const size_t &count) const {
+    if (count == 0) {
+        return 0;
+    }
+    if (tail_count_ > 0 && count == tail_count_) {
+        return 1;
+    }
+    return interval_ > 0 && count % interval_ == 0 && count / interval_ <= levels_.size();
+}
+
+size_t CutoffSeries::indexOf(const size_t &count) const {
+    if (this->count(count) == 0) {
+        return size();
+    }
+    return count == tail_count_ ? levels_.size() : count / interval_ - 1;
+}
+
+CutoffSeries::const_iterator CutoffSeries::find(const size_t &count) const {
+    return const_iterator(this, indexOf(count));
+}
+
+size_t CutoffSeries::operator[](const size_t &count) const {
+    const size_t i = indexOf(count);
+    return i == size() ? 0 : entry(i).second;
+}
+
+size_t CutoffSeries::cutoffAt(const size_t &count) const {
+    if (tail_count_ > 0 && count >= tail_count_) {
+        return tail_level_;
+    }
+
+    const size_t milestones = interval_ == 0 ? 0 : std::min(count / interval_, levels_.size());
+    if (milestones == 0) {
+        throw std::out_of_range("No cutoff recorded at or before count " + std::to_string(count));
+    }
+    return levels_[milestones - 1];
+}
+
+std::vector<std::pair<size_t, size_t>> CutoffSeries::range(const size_t &first, const size_t &last) const {
+    std::vector<std::pair<size_t, size_t>> entries;
+    if (levels_.empty() && tail_count_ == 0) {
+        return entries;
+    }
+
+    // Jump straight to the first milestone at or after `first`
+    const size_t start = interval_ == 0 ? 0 : std::min((first + interval_ - 1) / interval_, levels_.size() + 1);
+    for (size_t i = std::max<size_t>(start, 1) - 1; i < size(); ++i) {
+        const std::pair<size_t, size_t> curr = entry(i);
+        if (curr.first > last) {
+            break;
+        }
+        if (curr.first >= first) {
+            entries.push_back(curr);
+        }
+    }
+    return entries;
+}
+
+std::pair<size_t, size_t> CutoffSeries::entry(const size_t &i) const {
+    if (i < levels_.size()) {
+        return {(i + 1) * interval_, levels_[i]};
+    }
+    return {tail_count_, tail_level_};
+}
+
+size_t CutoffSeries::interval() const {
+    return interval_;
+}
+
+size_t CutoffSeries::size() const {
+    return levels_.size() + (tail_count_ > 0);
+}
+
+bool CutoffSeries::empty() const {
+    return size() == 0;
+}
+
+void CutoffSeries::clear() {
+    levels_.clear();
+    tail_count_ = 0;
+    tail_level_ = 0;
+}
+
+CutoffSeries::const_iterator CutoffSeries::begin() const {
+    return const_iterator(this, 0);
+}
+
+CutoffSeries::const_iterator CutoffSeries::end() const {
+    return const_iterator(this, size());
+}
+
+std::unordered_map<size_t, size_t> CutoffSeries::toMap() const {
+    std::unordered_map<size_t, size_t> cutoffs;
+    cutoffs.reserve(size());
+    for (const auto &[count, level] : *this) {
+        cutoffs[count] = level;
+    }
+    return cutoffs;
+}
+
+CutoffSeries::operator std::unordered_map<size_t, size_t>() const {
+    return toMap();
+}
+
+bool CutoffSeries::operator==(const CutoffSeries &rhs) const {
+    return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+}
+
+bool CutoffSeries::operator!=(const CutoffSeries &rhs) const {
+    return !(*this == rhs);
+}
+
+bool CutoffSeries::operator==(const std::unordered_map<size_t, size_t> &rhs) const {
+    if (size() != rhs.size()) {
+        return false;
+    }
+    for (const auto &[count, level] : *this) {
+        const auto found = rhs.find(count);
+        if (found == rhs.end() || found->second != level) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CutoffSeries::operator!=(const std::unordered_map<size_t, size_t> &rhs) const {
+    return !(*this == rhs);
+}
+
+bool operator==(const std::unordered_map<size_t, size_t> &lhs, const CutoffSeries &rhs) {
+    return rhs == lhs;
+}
+
+bool operator!=(const std::unordered_map<size_t, size_t> &lhs, const CutoffSeries &rhs) {
+    return !(rhs == lhs);
+}
+
+std::string RankingMetrics::toJson() const {
+    char json[512];
+    std::snprintf(json, sizeof(json),
+                  "{\"fetch_ms\":%.4f,\"stall_ms\":%.4f,\"build_ms\":%.4f,\"replace_ms\":%.4f,\"sort_ms\":%.4f,"
+                  "\"comparisons\":%zu,\"swaps\":%zu,\"replacements\":%zu,\"players_fetched\":%zu,\"bytes_fetched\":%zu}",
+                  fetch_ms_, stall_ms_, build_ms_, replace_ms_, sort_ms_, comparisons_, swaps_, replacements_, players_fetched_, bytes_fetched_);
+    return json;
+}
 
 /**
  * @brief Constructor for RankingResult with top players, cutoffs, and elapsed time.
  *
  * @param top Vector of top-ranked Player objects, in sorted order.
- * @param cutoffs Map of player count thresholds to minimum level cutoffs.
+ * @param cutoffs Series (or legacy map) of player count thresholds to minimum level cutoffs.
  *   NOTE: This is only ever non-empty for Online::rankIncoming().
  *         This parameter & the corresponding member should be empty
  *         for all Offline algorithms.
  * @param elapsed Time taken to calculate the ranking, in seconds.
  */
-RankingResult::RankingResult(const std::vector<Player> &top, const std::unordered_map<size_t, size_t> &cutoffs, double elapsed)
-    : top_{top}, cutoffs_{cutoffs}, elapsed_{elapsed} {
+RankingResult::RankingResult(std::vector<Player> top, CutoffSeries cutoffs, double elapsed)
+    : top_{std::move(top)}, cutoffs_{std::move(cutoffs)}, elapsed_{elapsed} {
+}
+
+uint64_t packStableKey(const size_t &level, const size_t &tie) {
+    constexpr size_t LIMIT = std::numeric_limits<uint32_t>::max();
+    if (level > LIMIT || tie > LIMIT) {
+        throw std::out_of_range("Stable keys need levels & tie-breakers below 2^32, got (" + std::to_string(level) + ", " + std::to_string(tie) + ")");
+    }
+    // ~tie, so the earlier (or lower-id) of two tied Players has the greater key
+    return static_cast<uint64_t>(level) << 32 | (~tie & LIMIT);
 }
 
 /**
@@ -20,6 +219,8 @@ RankingResult::RankingResult(const std::vector<Player> &top, const std::unordere
  *        (excluding the returned RankingResult vector)
  *
  * @param players A reference to the vector of Player objects to be ranked
+ * @param backend Whether to rank the Players themselves, or RankKeys for them
+ * @param transfer Whether top_ is copied from `players` or moved out of it
  * @return A Ranking Result object whose
  * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending)
  * - cutoffs_    -> Is empty
@@ -27,22 +228,26 @@ RankingResult::RankingResult(const std::vector<Player> &top, const std::unordere
  *
  * @post The order of the parameter vector is modified.
  */
-RankingResult Offline::heapRank(std::vector<Player> &players) {
-    const auto t1 = std::chrono::high_resolution_clock::now();
-
-    RankingResult result;
-    int topTen = std::floor(0.1 * players.size());
-    std::make_heap(players.begin(), players.end()); // max-heap
-    for (int i = 0; i < topTen; ++i) {
-        std::pop_heap(players.begin(), players.end() - i);
+RankingResult Offline::heapRank(std::vector<Player> &players, Backend backend, Transfer transfer) {
+    if (backend == Backend::Keys) {
+        return heapRankKeys(players, transfer);
     }
-    result.top_.insert(result.top_.begin(), players.end() - topTen, players.end());
-    std::sort(result.top_.begin(), result.top_.end());
+    return heapRankBy(players, ByLevel{}, std::less<>{}, transfer);
+}
 
-    const auto t2 = std::chrono::high_resolution_clock::now();
-    const std::chrono::duration<double, std::milli> time = t2 - t1;
-    result.elapsed_ = time.count();
-    return result;
+RankingResult Offline::heapRank(std::vector<Player> &&players, Backend backend) {
+    return heapRank(players, backend, Transfer::Move);
+}
+
+/**
+ * @brief Pops the top 10% of players off a max-heap of `players`,
+ *        leaving them sorted (ascending) at its tail.
+ *
+ * @return A view of that tail, & the duration (ms) of the selection/sorting operation
+ * @post The order of the parameter vector is modified.
+ */
+RankingView Offline::heapRankView(std::vector<Player> &players) {
+    return heapRankViewBy(players);
 }
 
 /**
@@ -51,6 +256,8 @@ RankingResult Offline::heapRank(std::vector<Player> &players) {
  *        (excluding the returned RankingResult vector)
  *
  * @param players A reference to the vector of Player objects to be ranked
+ * @param backend Whether to rank the Players themselves, or RankKeys for them
+ * @param transfer Whether top_ is copied from `players` or moved out of it
  * @return A Ranking Result object whose
  * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending)
  * - cutoffs_    -> Is empty
@@ -58,128 +265,190 @@ RankingResult Offline::heapRank(std::vector<Player> &players) {
  *
  * @post The order of the parameter vector is modified.
  */
-RankingResult Offline::quickSelectRank(std::vector<Player> &players) {
-    const auto t1 = std::chrono::high_resolution_clock::now();
-
-    RankingResult result;
-    int topTen = players.size() - (std::floor(0.1 * players.size()));
-    quickSelect(players, 0, players.size() - 1, topTen);
-    quickSort(players, topTen, players.size() - 1);
-    result.top_.insert(result.top_.end(), players.begin() + topTen, players.end());
+RankingResult Offline::quickSelectRank(std::vector<Player> &players, Backend backend, Transfer transfer) {
+    if (backend == Backend::Keys) {
+        return quickSelectRankKeys(players, transfer);
+    }
+    return quickSelectRankBy(players, ByLevel{}, std::less<>{}, transfer);
+}
 
-    const auto t2 = std::chrono::high_resolution_clock::now();
-    const std::chrono::duration<double, std::milli> time = t2 - t1;
-    result.elapsed_ = time.count();
-    return result;
+RankingResult Offline::quickSelectRank(std::vector<Player> &&players, Backend backend) {
+    return quickSelectRank(players, backend, Transfer::Move);
 }
 
 /**
- * @brief A helper method that replaces the minimum element
- * in a min-heap with a target value & preserves the heap
- * by percolating the new value down to its correct position.
- *
- * Performs in O(log N) time.
- *
- * @pre The range [first, last) is a min-heap.
+ * @brief Quickselects the top 10% of players to the tail of `players`, then quicksorts that tail.
  *
- * @param first An iterator to a vector of Player objects
- *      denoting the beginning of a min-heap
- *      NOTE: Unlike the textbook, this is *not* an empty slot
- *      used to store temporary values. It is the root of the heap.
+ * @return A view of that tail, & the duration (ms) of the selection/sorting operation
+ * @post The order of the parameter vector is modified.
+ */
+RankingView Offline::quickSelectRankView(std::vector<Player> &players) {
+    return quickSelectRankViewBy(players);
+}
+
+/**
+ * @brief Selects & sorts the top 10% of players using up to `threads` threads,
+ *        by reducing each shard to its own top, then selecting & sorting among those candidates.
  *
- * @param last An iterator to a vector of Player objects
- *      denoting one past the end of a min-heap
- *      (i.e. it is not considering a valid index of the heap)
+ * @param players A reference to the vector of Player objects to be ranked
+ * @param threads The number of threads to use; 0 is treated as 1
+ * @param transfer Whether the candidates are copied from `players` or moved out of it
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending)
+ * - cutoffs_    -> Is empty
+ * - elapsed_    -> Contains the duration (ms) of the selection/sorting operation
  *
- * @param target A reference to a Player object to be inserted into the heap
- * @post
- * - The vector slice denoted from [first,last) is a min-heap
- *   into which `target` has been inserted.
- * - The contents of `target` is not guaranteed to match its original state
- *   (ie. you may move it).
+ * @post The order of the parameter vector is modified.
  */
-void Online::replaceMin(PlayerIt first, PlayerIt last, Player &target) {
-    auto size = std::distance(first, last);
-
-    *first = std::move(target);
-    int index = 0;
-
-    while (true) {
-        int child = index * 2 + 1;
-        int smallerChild = index;
+RankingResult Offline::parallelRank(std::vector<Player> &players, unsigned threads, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
 
-        if (child < size && *std::next(first, child) < *std::next(first, smallerChild)) {
-            smallerChild = child; // Left Child
-        }
+    RankingResult result;
+    const size_t size = players.size();
+    const size_t topTen = std::floor(0.1 * size);
+    const unsigned shards = std::max<size_t>(1, std::min<size_t>(threads, topTen));
+    auto shardStart = [size, shards](unsigned i) { return static_cast<int>(size * i / shards); };
 
-        if (child + 1 < size && *std::next(first, child + 1) < *std::next(first, smallerChild)) {
-            smallerChild = child + 1; // Right Child
+    // 1) Move each shard's top to the shard's tail
+    forEachThread(shards, [&](unsigned i) {
+        const int low = shardStart(i), high = shardStart(i + 1) - 1;
+        const int keep = std::min<int>(topTen, high - low + 1);
+        if (keep > 0) {
+            quickSelect(players, low, high, high + 1 - keep);
         }
+    });
 
-        if (smallerChild != index) {
-            std::swap(*std::next(first, index), *std::next(first, smallerChild));
-            index = smallerChild;
+    // 2) Select the overall top among the shards' tops
+    std::vector<Player> candidates;
+    for (unsigned i = 0; i < shards; ++i) {
+        const int keep = std::min<int>(topTen, shardStart(i + 1) - shardStart(i));
+        const auto shardEnd = players.begin() + shardStart(i + 1);
+        if (transfer == Transfer::Move) {
+            candidates.insert(candidates.end(), std::make_move_iterator(shardEnd - keep), std::make_move_iterator(shardEnd));
         } else {
-            break;
+            candidates.insert(candidates.end(), shardEnd - keep, shardEnd);
         }
     }
+    const int first = candidates.size() - topTen;
+    const int last = candidates.size() - 1;
+    quickSelect(candidates, 0, last, first);
+
+    // 3) Sort slices of the top in parallel, then merge neighbouring slices until one remains
+    std::vector<int> bounds;
+    for (unsigned i = 0; i <= shards; ++i) {
+        bounds.push_back(first + static_cast<int>(topTen * i / shards));
+    }
+    forEachThread(shards, [&](unsigned i) { quickSort(candidates, bounds[i], bounds[i + 1] - 1); });
+    for (unsigned width = 1; width < shards; width *= 2) {
+        const unsigned merges = (shards + 2 * width - 1) / (2 * width);
+        forEachThread(merges, [&](unsigned i) {
+            const unsigned left = 2 * width * i;
+            const unsigned mid = std::min(left + width, shards), right = std::min(left + 2 * width, shards);
+            std::inplace_merge(candidates.begin() + bounds[left], candidates.begin() + bounds[mid], candidates.begin() + bounds[right]);
+        });
+    }
+    // The candidates are scratch, so the top can always be moved out of them
+    result.top_ = transferRange(candidates.begin() + first, candidates.end(), Transfer::Move);
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+RankingResult Offline::stableRank(std::vector<Player> &players, TieBreak tie_break, unsigned threads, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const size_t size = players.size();
+    const size_t topTen = std::floor(0.1 * size);
+    std::vector<StableKey> keys(size);
+    for (size_t i = 0; i < size; ++i) {
+        keys[i] = {packStableKey(players[i].level_, tie_break == TieBreak::Id ? players[i].id_ : i), i};
+    }
+
+    // Under a total order, each shard's top holds exactly its members of the overall top
+    const unsigned shards = std::max<size_t>(1, std::min<size_t>(threads, topTen));
+    auto shardStart = [size, shards](unsigned i) { return size * i / shards; };
+    forEachThread(shards, [&](unsigned i) {
+        const auto low = keys.begin() + shardStart(i), high = keys.begin() + shardStart(i + 1);
+        const size_t keep = std::min<size_t>(topTen, high - low);
+        std::nth_element(low, high - keep, high);
+    });
+
+    std::vector<StableKey> top;
+    for (unsigned i = 0; i < shards; ++i) {
+        const auto high = keys.begin() + shardStart(i + 1);
+        const size_t keep = std::min<size_t>(topTen, shardStart(i + 1) - shardStart(i));
+        top.insert(top.end(), high - keep, high);
+    }
+    const auto first = top.end() - topTen;
+    std::nth_element(top.begin(), first, top.end());
+    std::sort(first, top.end());
+
+    RankingResult result;
+    result.top_.reserve(topTen);
+    for (auto key = first; key != top.end(); ++key) {
+        Player &player = players[key->index_];
+        result.top_.push_back(transfer == Transfer::Move ? std::move(player) : player);
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
 }
 
+namespace {
 /**
- * @brief Exhausts a stream of Players (ie. until there are none left) such that we:
- * 1) Maintain a running collection of the <reporting_interval> highest leveled players
- * 2) Record the Player level after reading every <reporting_interval> players
- *    representing the minimum level required to be in the leaderboard at that point.
- *
- * @note You should use NOT use a priority-queue.
- *       Instead, use a vector, the STL heap operations, & `replaceMin()`
- *
- * @param stream A stream providing Player objects
- * @param reporting_interval The frequency at which to record cutoff levels
- * @return A RankingResult in which:
- * - top_       -> Contains the top <reporting_interval> Players read in the stream in
- *                 sorted (least to greatest) order
- * - cutoffs_   -> Maps player count milestones to minimum level required at that point
- *                 including the minimum level after ALL players have been read, regardless
- *                 of being a multiple of the reporting interval
- * - elapsed_   -> Contains the duration (ms) of the selection/sorting operation
- *                 excluding fetching the next player in the stream
- *
- * @post All elements of the stream are read until there are none remaining.
- *
- * @example Suppose we have:
- * 1) A stream with 132 players
- * 2) A reporting interval of 50
- *
- * Then our resulting RankingResult might contain something like:
- * top_ = { Player("RECLUSE", 994), Player("WYLDER", 1002), ..., Player("DUCHESS", 1399) }, with length 50
- * cutoffs_ = { 50: 239, 100: 992, 132: 994 } (see RankingResult explanation)
- * elapsed_ = 0.003 (Your runtime will vary based on hardware)
+ * @brief countingRank(), given the highest level in `players`.
  */
-RankingResult Online::rankIncoming(PlayerStream &stream, const size_t &reporting_interval) {
-    const auto t1 = std::chrono::high_resolution_clock::now();
+RankingResult countingRankBelow(std::vector<Player> &players, const size_t &maxLevel, Transfer transfer) {
+    const size_t topTen = std::floor(0.1 * players.size());
     RankingResult result;
-    int count = 0;
+    if (topTen == 0) {
+        return result;
+    }
 
-    std::vector<Player> topReportPlayers;
-    while (stream.remaining() > 0) {
-        Player currPlayer = stream.nextPlayer();
-        count++;
-        if (topReportPlayers.size() < reporting_interval) {
-            topReportPlayers.push_back(currPlayer);
-            std::make_heap(topReportPlayers.begin(), topReportPlayers.end(), std::greater<>());
+    result.top_.reserve(topTen);
+    for (const RankKey &key : Offline::countTopKeys(LevelColumn(players), topTen, maxLevel)) {
+        Player &player = players[key.index_];
+        result.top_.push_back(transfer == Transfer::Move ? std::move(player) : player);
+    }
+    return result;
+}
 
-        } else if (currPlayer > topReportPlayers[0]) {
-            replaceMin(topReportPlayers.begin(), topReportPlayers.end(), currPlayer);
-        }
+size_t maxLevel(const std::vector<Player> &players) {
+    size_t level = 0;
+    for (const Player &player : players) {
+        level = std::max(level, player.level_);
+    }
+    return level;
+}
+} // namespace
 
-        if (count % reporting_interval == 0 && topReportPlayers.empty() == false) {
-            result.cutoffs_[count] = topReportPlayers[0].level_;
-        }
+RankingResult Offline::countingRank(std::vector<Player> &players, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const size_t highest = maxLevel(players);
+    if (highest >= COUNTING_LEVEL_THRESHOLD) {
+        throw std::invalid_argument("countingRank() requires levels below COUNTING_LEVEL_THRESHOLD, got " + std::to_string(highest));
     }
+    RankingResult result = countingRankBelow(players, highest, transfer);
 
-    std::sort(topReportPlayers.begin(), topReportPlayers.end());
-    result.top_ = topReportPlayers;
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+RankingResult Offline::rank(std::vector<Player> &players, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const size_t highest = maxLevel(players);
+    if (highest >= COUNTING_LEVEL_THRESHOLD || highest > players.size()) {
+        return quickSelectRank(players, Backend::Objects, transfer);
+    }
+    RankingResult result = countingRankBelow(players, highest, transfer);
 
     const auto t2 = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<double, std::milli> time = t2 - t1;
@@ -187,38 +456,1454 @@ RankingResult Online::rankIncoming(PlayerStream &stream, const size_t &reporting
     return result;
 }
 
-// Helper Functions For quickSelectRank
-int Offline::partition(std::vector<Player> &players, int &low, int &high) {
-    int lower = low;
-    Player x = players[high];
-    for (int i = lower; i < high; i++) {
-        if (players[i].level_ <= x.level_) {
-            std::swap(players[lower], players[i]);
-            lower++;
-        }
+RankingResult Offline::rankTopK(std::vector<Player> &players, const size_t &k, Selection selection, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const size_t size = players.size();
+    const size_t count = std::min(k, size);
+    if (selection == Selection::Auto) {
+        selection = count <= size / PARTIAL_HEAP_DIVISOR ? Selection::PartialHeap : Selection::SelectSort;
+    }
+
+    // Both selections work on RankKeys, so neither moves Players around until the final gather
+    std::vector<RankKey> top;
+    if (count > 0 && selection == Selection::PartialHeap) {
+        top = heapTopKeys(LevelColumn(players), count);
+    } else if (count > 0) {
+        top = makeKeys(players);
+        const auto first = top.end() - count;
+        std::nth_element(top.begin(), first, top.end());
+        std::sort(first, top.end());
+        top.erase(top.begin(), first);
+    }
+
+    RankingResult result;
+    result.top_.reserve(top.size());
+    for (const RankKey &key : top) {
+        Player &player = players[key.index_];
+        result.top_.push_back(transfer == Transfer::Move ? std::move(player) : player);
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+RankingResult Offline::rankTopFraction(std::vector<Player> &players, const double &fraction, Selection selection, Transfer transfer) {
+    if (!(fraction >= 0 && fraction <= 1)) {
+        throw std::invalid_argument("The top fraction must be within [0, 1], got " + std::to_string(fraction));
     }
-    std::swap(players[lower], players[high]);
-    return lower;
+    return rankTopK(players, std::floor(fraction * players.size()), selection, transfer);
 }
 
-void Offline::quickSort(std::vector<Player> &players, int low, int high) {
-    if (low < high) {
-        int pivot = partition(players, low, high);
-        quickSort(players, low, pivot - 1);
-        quickSort(players, pivot + 1, high);
+size_t Offline::externalBucket(const size_t &level) {
+    constexpr int EXACT_BITS = 10;
+    if (level < (size_t(1) << EXACT_BITS)) {
+        return level;
     }
+
+    // The bit width, then the 9 bits after the leading one
+    const int shift = (64 - __builtin_clzll(level)) - EXACT_BITS;
+    return shift * (size_t(1) << EXACT_BITS) + (level >> shift);
 }
 
-void Offline::quickSelect(std::vector<Player> &players, int low, int high, int k) {
-    if (low < high) {
-        int pivot = partition(players, low, high);
+RankingResult Offline::externalRank(PlayerStream &first, PlayerStream &second) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
 
-        if (pivot == k) {
-            return;
-        } else if (pivot < k) {
-            quickSelect(players, pivot + 1, high, k);
-        } else {
-            quickSelect(players, low, pivot - 1, k);
+    // 1) Histogram the levels
+    std::vector<size_t> counts(EXTERNAL_BUCKETS);
+    size_t size = 0;
+    for (PlayerChunk chunk = first.nextChunk(Online::CHUNK_SIZE); !chunk.empty(); chunk = first.nextChunk(Online::CHUNK_SIZE)) {
+        for (const Player &player : chunk) {
+            counts[externalBucket(player.level_)]++;
         }
+        size += chunk.size();
+    }
+    if (second.remaining() != size) {
+        throw std::invalid_argument("externalRank() read " + std::to_string(size) + " players from the first stream, but the second holds " +
+                                    std::to_string(second.remaining()));
+    }
+
+    const size_t topTen = std::floor(0.1 * size);
+    // `above` counts the Players in buckets above `cutoff`, & `needed` those the top takes from within it
+    size_t cutoff = EXTERNAL_BUCKETS, above = 0, needed = 0;
+    if (topTen > 0) {
+        do {
+            above += counts[--cutoff];
+        } while (above < topTen);
+        above -= counts[cutoff];
+        needed = topTen - above;
     }
+
+    // 2) Keep everyone above the cutoff bucket, & the best `needed` within it
+    RankingResult result;
+    result.top_.reserve(topTen);
+    std::vector<Player> boundary;
+    boundary.reserve(needed);
+    for (PlayerChunk chunk = second.nextChunk(Online::CHUNK_SIZE); !chunk.empty(); chunk = second.nextChunk(Online::CHUNK_SIZE)) {
+        for (const Player &player : chunk) {
+            const size_t bucket = externalBucket(player.level_);
+            if (bucket > cutoff) {
+                result.top_.push_back(player);
+            } else if (bucket == cutoff && needed > 0) {
+                if (boundary.size() < needed) {
+                    boundary.push_back(player);
+                    std::push_heap(boundary.begin(), boundary.end(), std::greater<>());
+                } else if (player.level_ > boundary[0].level_) {
+                    Online::replaceMin(boundary.begin(), boundary.end(), player);
+                }
+            }
+        }
+    }
+    if (result.top_.size() != above || boundary.size() != needed) {
+        throw std::runtime_error("externalRank()'s streams hold different levels");
+    }
+
+    result.top_.insert(result.top_.end(), std::make_move_iterator(boundary.begin()), std::make_move_iterator(boundary.end()));
+    if (!result.top_.empty()) {
+        quickSort(result.top_, 0, result.top_.size() - 1);
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+std::vector<RankKey> Offline::makeKeys(const std::vector<Player> &players) {
+    std::vector<RankKey> keys(players.size());
+    for (size_t i = 0; i < players.size(); ++i) {
+        keys[i] = {players[i].level_, i};
+    }
+    return keys;
+}
+
+std::vector<RankKey> Offline::makeKeys(const LevelColumn &levels) {
+    std::vector<RankKey> keys(levels.size_);
+    for (size_t i = 0; i < levels.size_; ++i) {
+        keys[i] = {levels[i], i};
+    }
+    return keys;
+}
+
+std::vector<RankKey> Offline::countTopKeys(const LevelColumn &levels, const size_t &k, const size_t &maxLevel) {
+    std::vector<size_t> counts(maxLevel + 1);
+    for (size_t i = 0; i < levels.size_; ++i) {
+        counts[levels[i]]++;
+    }
+
+    // Walk down until the top k is reached; `cutoff` is the lowest level in it
+    size_t cutoff = maxLevel + 1, above = 0;
+    while (above < k) {
+        above += counts[--cutoff];
+    }
+    size_t ties = k - (above - counts[cutoff]);
+
+    // Turn the counts at & above the cutoff into each level's first index in the top
+    size_t offset = 0;
+    for (size_t level = cutoff; level <= maxLevel; ++level) {
+        const size_t count = level == cutoff ? ties : counts[level];
+        counts[level] = offset;
+        offset += count;
+    }
+
+    std::vector<RankKey> top(k);
+    for (size_t i = 0; i < levels.size_; ++i) {
+        const size_t level = levels[i];
+        if (level < cutoff) {
+            continue;
+        }
+        if (level == cutoff) {
+            if (ties == 0) {
+                continue;
+            }
+            ties--;
+        }
+        top[counts[level]++] = {level, i};
+    }
+    return top;
+}
+
+std::vector<RankKey> Offline::heapTopKeys(const LevelColumn &levels, const size_t &k) {
+    std::vector<RankKey> top;
+    top.reserve(k);
+    size_t i = 0;
+    for (; i < levels.size_ && top.size() < k; ++i) {
+        top.push_back({levels[i], i});
+        std::push_heap(top.begin(), top.end(), std::greater<>());
+    }
+    for (i = Online::findAbove(levels, i, top[0].level_); i != levels.size_; i = Online::findAbove(levels, i + 1, top[0].level_)) {
+        RankKey key{levels[i], i};
+        Online::replaceMin(top.begin(), top.end(), key);
+    }
+    std::sort(top.begin(), top.end());
+    return top;
+}
+
+/**
+ * @brief Backend::Keys version of heapRank(): pops the top 10% of RankKeys off a max-heap,
+ *        then gathers the matching Players.
+ */
+RankingResult Offline::heapRankKeys(std::vector<Player> &players, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    RankingResult result;
+    const size_t topTen = std::floor(0.1 * players.size());
+    std::vector<RankKey> keys = makeKeys(players);
+    std::make_heap(keys.begin(), keys.end()); // max-heap
+    for (size_t i = 0; i < topTen; ++i) {
+        std::pop_heap(keys.begin(), keys.end() - i);
+    }
+
+    // Popping a max-heap leaves its tail in ascending order
+    result.top_.reserve(topTen);
+    for (auto key = keys.end() - topTen; key != keys.end(); ++key) {
+        Player &player = players[key->index_];
+        result.top_.push_back(transfer == Transfer::Move ? std::move(player) : player);
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+RankingResult Offline::heapRankCompact(std::vector<CompactPlayer> &players, const NameTable &names) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    RankingResult result;
+    const size_t topTen = std::floor(0.1 * players.size());
+    std::make_heap(players.begin(), players.end()); // max-heap
+    for (size_t i = 0; i < topTen; ++i) {
+        std::pop_heap(players.begin(), players.end() - i);
+    }
+
+    result.top_.reserve(topTen);
+    for (auto player = players.end() - topTen; player != players.end(); ++player) {
+        result.top_.push_back(player->toPlayer(names));
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+/**
+ * @brief Backend::Keys version of quickSelectRank(): selects & sorts the top 10% of RankKeys,
+ *        then gathers the matching Players.
+ */
+RankingResult Offline::quickSelectRankKeys(std::vector<Player> &players, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    RankingResult result;
+    const size_t topTen = std::floor(0.1 * players.size());
+    std::vector<RankKey> keys = makeKeys(players);
+    const auto first = keys.end() - topTen;
+    std::nth_element(keys.begin(), first, keys.end());
+    std::sort(first, keys.end());
+
+    result.top_.reserve(topTen);
+    for (auto key = first; key != keys.end(); ++key) {
+        Player &player = players[key->index_];
+        result.top_.push_back(transfer == Transfer::Move ? std::move(player) : player);
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+namespace {
+/**
+ * @brief The counter siftDownRoot() reports its work to by default, which ignores it.
+ */
+struct Uncounted {
+    void compared(int) {}
+    void swapped() {}
+};
+
+/**
+ * @brief A siftDownRoot() counter that adds its work to a RankingMetrics.
+ */
+struct Counted {
+    RankingMetrics &metrics_;
+
+    void compared(int count) { metrics_.comparisons_ += count; }
+    void swapped() { metrics_.swaps_++; }
+};
+
+/**
+ * @brief Percolates the root of the min-heap [first, last) down to its correct position,
+ *        reporting its comparisons & swaps to `counter`.
+ */
+template <typename It, typename Counter = Uncounted>
+void siftDownRoot(It first, It last, Counter counter = {}) {
+    auto size = std::distance(first, last);
+    int index = 0;
+
+    while (true) {
+        int child = index * 2 + 1;
+        int smallerChild = index;
+        counter.compared((child < size) + (child + 1 < size));
+
+        if (child < size && *std::next(first, child) < *std::next(first, smallerChild)) {
+            smallerChild = child; // Left Child
+        }
+
+        if (child + 1 < size && *std::next(first, child + 1) < *std::next(first, smallerChild)) {
+            smallerChild = child + 1; // Right Child
+        }
+
+        if (smallerChild != index) {
+            counter.swapped();
+            std::swap(*std::next(first, index), *std::next(first, smallerChild));
+            index = smallerChild;
+        } else {
+            break;
+        }
+    }
+}
+} // namespace
+
+/**
+ * @brief A helper method that replaces the minimum element
+ * in a min-heap with a target value & preserves the heap
+ * by percolating the new value down to its correct position.
+ *
+ * Performs in O(log N) time.
+ *
+ * @pre The range [first, last) is a min-heap.
+ *
+ * @param first An iterator to a vector of Player objects
+ *      denoting the beginning of a min-heap
+ *      NOTE: Unlike the textbook, this is *not* an empty slot
+ *      used to store temporary values. It is the root of the heap.
+ *
+ * @param last An iterator to a vector of Player objects
+ *      denoting one past the end of a min-heap
+ *      (i.e. it is not considering a valid index of the heap)
+ *
+ * @param target A reference to a Player object to be inserted into the heap
+ * @post
+ * - The vector slice denoted from [first,last) is a min-heap
+ *   into which `target` has been inserted.
+ * - The contents of `target` is not guaranteed to match its original state
+ *   (ie. you may move it).
+ */
+void Online::replaceMin(PlayerIt first, PlayerIt last, Player &target) {
+    *first = std::move(target);
+    siftDownRoot(first, last);
+}
+
+void Online::replaceMin(PlayerIt first, PlayerIt last, const Player &target) {
+    // Copy-assigning over the evicted minimum reuses its name's buffer
+    *first = target;
+    siftDownRoot(first, last);
+}
+
+void Online::replaceMin(KeyIt first, KeyIt last, RankKey &target) {
+    *first = target;
+    siftDownRoot(first, last);
+}
+
+const Player *Online::findAboveScalar(const Player *first, const Player *last, const size_t &threshold) {
+    while (first != last && first->level_ <= threshold) {
+        ++first;
+    }
+    return first;
+}
+
+size_t Online::findAboveScalar(const LevelColumn &levels, size_t from, const size_t &threshold) {
+    while (from != levels.size_ && levels[from] <= threshold) {
+        ++from;
+    }
+    return from;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+namespace {
+__attribute__((target("avx2"))) size_t findAboveAvx2(const LevelColumn &levels, size_t from, const size_t &threshold) {
+    const long long stride = levels.stride_;
+    const __m256i offsets = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+
+    // AVX2 only compares signed 64-bit lanes, so flip the sign bits to compare unsigned levels
+    const __m256i bias = _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+    const __m256i limit = _mm256_xor_si256(_mm256_set1_epi64x(threshold), bias);
+
+    for (; levels.size_ - from >= 8; from += 8) {
+        const unsigned char *first = levels.first_ + from * levels.stride_;
+        const __m256i low = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(first), offsets, 1);
+        const __m256i high = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(first + 4 * stride), offsets, 1);
+        const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_xor_si256(low, bias), limit))) |
+                         _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_xor_si256(high, bias), limit))) << 4;
+        if (mask != 0) {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    return Online::findAboveScalar(levels, from, threshold);
+}
+} // namespace
+#endif
+
+size_t Online::findAbove(const LevelColumn &levels, size_t from, const size_t &threshold) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        return findAboveAvx2(levels, from, threshold);
+    }
+#endif
+    return findAboveScalar(levels, from, threshold);
+}
+
+const Player *Online::findAbove(const Player *first, const Player *last, const size_t &threshold) {
+    return first + findAbove(LevelColumn(first, last - first), 0, threshold);
+}
+
+Online::Leaderboard::Leaderboard(const size_t &reporting_interval, const size_t &publish_every)
+    : reporting_interval_{reporting_interval}, count_{0}, cutoffs_{reporting_interval}, stale_{false}, logging_{false}, publish_every_{publish_every}, version_{0},
+      published_cutoff_{0}, current_{PUBLISH_SLOTS} {
+    heap_.reserve(reporting_interval_);
+}
+
+void Online::Leaderboard::ingest(const Player &player) {
+    ingest(PlayerChunk{&player, &player + 1});
+}
+
+void Online::Leaderboard::ingest(const PlayerChunk &players) {
+    const Player *curr = players.begin();
+    while (curr != players.end()) {
+        // Only consume up to the next reporting boundary, so the loops below need no per-Player bookkeeping
+        const size_t untilReport = reporting_interval_ - count_ % reporting_interval_;
+        const Player *segmentEnd = curr + std::min<size_t>(untilReport, players.end() - curr);
+        count_ += segmentEnd - curr;
+
+        // Until the leaderboard is full, every Player makes it: sift each one up in O(log r)
+        std::chrono::high_resolution_clock::time_point t1, t2;
+        if constexpr (METRICS_ENABLED) {
+            t1 = std::chrono::high_resolution_clock::now();
+        }
+        for (; curr != segmentEnd && heap_.size() < reporting_interval_; ++curr) {
+            heap_.push_back(*curr);
+            if constexpr (METRICS_ENABLED) {
+                // Every comparison that finds the parent higher moves it down a level
+                std::push_heap(heap_.begin(), heap_.end(), [this](const Player &lhs, const Player &rhs) {
+                    metrics_.comparisons_++;
+                    const bool higher = lhs > rhs;
+                    metrics_.swaps_ += higher;
+                    return higher;
+                });
+            } else {
+                std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+            }
+            noteAdmitted(*curr);
+        }
+
+        if constexpr (METRICS_ENABLED) {
+            t2 = std::chrono::high_resolution_clock::now();
+        }
+        if (curr != segmentEnd) {
+            if constexpr (METRICS_ENABLED) {
+                metrics_.comparisons_ += segmentEnd - curr; // findAbove() checks each Player against the cutoff once
+            }
+            curr = findAbove(curr, segmentEnd, heap_[0].level_);
+            for (; curr != segmentEnd; curr = findAbove(curr + 1, segmentEnd, heap_[0].level_)) {
+                if constexpr (METRICS_ENABLED) {
+                    // replaceMin(), counting the percolation's work
+                    heap_[0] = *curr;
+                    siftDownRoot(heap_.begin(), heap_.end(), Counted{metrics_});
+                    metrics_.replacements_++;
+                } else {
+                    replaceMin(heap_.begin(), heap_.end(), *curr);
+                }
+                noteAdmitted(*curr);
+            }
+        }
+
+        if constexpr (METRICS_ENABLED) {
+            const auto t3 = std::chrono::high_resolution_clock::now();
+            const std::chrono::duration<double, std::milli> build = t2 - t1, replace = t3 - t2;
+            metrics_.build_ms_ += build.count();
+            metrics_.replace_ms_ += replace.count();
+        }
+
+        if (count_ % reporting_interval_ == 0 && heap_.empty() == false) {
+            cutoffs_.record(count_, heap_[0].level_);
+            if (publish_every_ > 0 && count_ / reporting_interval_ % publish_every_ == 0) {
+                publish();
+            } else {
+                if (pending_) {
+                    swapInPending();
+                }
+                published_cutoff_.store(heap_[0].level_, std::memory_order_release);
+            }
+        }
+    }
+}
+
+size_t Online::Leaderboard::cutoff() const {
+    return heap_.empty() ? 0 : heap_[0].level_;
+}
+
+const std::vector<Player> &Online::Leaderboard::snapshot() const {
+    if (!stale_) {
+        return snapshot_;
+    }
+    if (!logging_) {
+        snapshot_ = heap_;
+        std::sort(snapshot_.begin(), snapshot_.end());
+    } else {
+        // Everything above the cutoff is still on the leaderboard, & everything below it has been evicted,
+        // but which of the Players tied at the cutoff were evicted only the heap knows
+        const size_t cutoff = heap_[0].level_;
+        auto atOrBelow = [&cutoff](const Player &player) { return player.level_ <= cutoff; };
+        std::sort(admitted_.begin(), admitted_.end());
+
+        std::vector<Player> next;
+        next.reserve(heap_.size());
+        for (const Player &player : heap_) {
+            if (player.level_ == cutoff) {
+                next.push_back(player);
+            }
+        }
+        std::merge(std::make_move_iterator(std::partition_point(snapshot_.begin(), snapshot_.end(), atOrBelow)), std::make_move_iterator(snapshot_.end()),
+                   std::make_move_iterator(std::partition_point(admitted_.begin(), admitted_.end(), atOrBelow)), std::make_move_iterator(admitted_.end()),
+                   std::back_inserter(next));
+        snapshot_.swap(next);
+    }
+    admitted_.clear();
+    logging_ = true;
+    stale_ = false;
+    return snapshot_;
+}
+
+const CutoffSeries &Online::Leaderboard::cutoffs() const {
+    return cutoffs_;
+}
+
+size_t Online::Leaderboard::count() const {
+    return count_;
+}
+
+size_t Online::Leaderboard::size() const {
+    return heap_.size();
+}
+
+const RankingMetrics &Online::Leaderboard::metrics() const {
+    return metrics_;
+}
+
+void Online::Leaderboard::publish() {
+    // Build the snapshot before swapping it in, so readers only ever see complete ones
+    pending_ = std::make_shared<const LeaderboardSnapshot>(LeaderboardSnapshot{snapshot(), count_, ++version_});
+    swapInPending();
+    published_cutoff_.store(cutoff(), std::memory_order_release);
+}
+
+// The slot counters & current_ use sequentially consistent operations: a reader's increment then
+// reload of current_, against the writer's check of the counter then store to current_, is a
+// store-load handshake that weaker orders would let both sides miss.
+void Online::Leaderboard::swapInPending() {
+    const size_t current = current_.load();
+    for (size_t i = 0; i < PUBLISH_SLOTS; ++i) {
+        // A reader that enters slot i from here on sees current_ != i & retries, so the slot is the writer's
+        if (i != current && slots_[i].readers_.load() == 0) {
+            slots_[i].snapshot_ = std::move(pending_);
+            current_.store(i);
+            return;
+        }
+    }
+}
+
+size_t Online::Leaderboard::publishedCutoff() const {
+    return published_cutoff_.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<const Online::LeaderboardSnapshot> Online::Leaderboard::published() const {
+    while (true) {
+        const size_t i = current_.load();
+        if (i == PUBLISH_SLOTS) {
+            return nullptr;
+        }
+        const PublishSlot &slot = slots_[i];
+        slot.readers_.fetch_add(1);
+        // Only copy the slot if it is still current once announced, so the writer cannot be refilling it
+        if (current_.load() == i) {
+            std::shared_ptr<const LeaderboardSnapshot> snapshot = slot.snapshot_;
+            slot.readers_.fetch_sub(1);
+            return snapshot;
+        }
+        slot.readers_.fetch_sub(1);
+    }
+}
+
+RankingResult Online::Leaderboard::finish() {
+    RankingResult result;
+    if (count_ % reporting_interval_ != 0 && heap_.empty() == false) {
+        cutoffs_.record(count_, heap_[0].level_);
+    }
+    const auto t1 = std::chrono::high_resolution_clock::now();
+    std::sort(heap_.begin(), heap_.end());
+    const std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - t1;
+    if constexpr (METRICS_ENABLED) {
+        metrics_.sort_ms_ += time.count();
+    }
+    result.top_ = std::move(heap_);
+    result.cutoffs_ = std::move(cutoffs_);
+    result.metrics_ = std::exchange(metrics_, RankingMetrics{});
+
+    heap_ = {};
+    heap_.reserve(reporting_interval_);
+    cutoffs_ = CutoffSeries(reporting_interval_);
+    snapshot_.clear();
+    admitted_.clear();
+    count_ = 0;
+    stale_ = false;
+    logging_ = false;
+    return result;
+}
+
+/**
+ * @brief Exhausts a stream of Players (ie. until there are none left) such that we:
+ * 1) Maintain a running collection of the <reporting_interval> highest leveled players
+ * 2) Record the Player level after reading every <reporting_interval> players
+ *    representing the minimum level required to be in the leaderboard at that point.
+ *
+ * @note You should use NOT use a priority-queue.
+ *       Instead, use a vector, the STL heap operations, & `replaceMin()`
+ *
+ * @note Players are pulled from the stream in chunks of up to CHUNK_SIZE & fed to a Leaderboard.
+ *       Once the leaderboard is full, each chunk is filtered against the
+ *       current minimum level so only Players that beat it reach the heap.
+ *
+ * @param stream A stream providing Player objects
+ * @param reporting_interval The frequency at which to record cutoff levels
+ * @param backend Whether the heap holds the Players themselves, or RankKeys for them
+ * @return A RankingResult in which:
+ * - top_       -> Contains the top <reporting_interval> Players read in the stream in
+ *                 sorted (least to greatest) order
+ * - cutoffs_   -> Maps player count milestones to minimum level required at that point
+ *                 including the minimum level after ALL players have been read, regardless
+ *                 of being a multiple of the reporting interval
+ * - elapsed_   -> Contains the duration (ms) of the selection/sorting operation
+ *                 excluding fetching the next player in the stream
+ *
+ * @post All elements of the stream are read until there are none remaining.
+ *
+ * @example Suppose we have:
+ * 1) A stream with 132 players
+ * 2) A reporting interval of 50
+ *
+ * Then our resulting RankingResult might contain something like:
+ * top_ = { Player("RECLUSE", 994), Player("WYLDER", 1002), ..., Player("DUCHESS", 1399) }, with length 50
+ * cutoffs_ = { 50: 239, 100: 992, 132: 994 } (see RankingResult explanation)
+ * elapsed_ = 0.003 (Your runtime will vary based on hardware)
+ */
+RankingResult Online::rankIncoming(PlayerStream &stream, const size_t &reporting_interval, Backend backend, unsigned arity) {
+    if (backend == Backend::Keys) {
+        return rankIncomingKeys(stream, reporting_interval, arity);
+    }
+    if (arity != 2) {
+        throw std::invalid_argument("Backend::Objects only supports a binary heap");
+    }
+
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    RankingMetrics fetched;
+    Leaderboard leaderboard(reporting_interval);
+    ChunkFetcher fetcher(stream, fetched);
+    for (PlayerChunk chunk = fetcher.next(); !chunk.empty(); chunk = fetcher.next()) {
+        leaderboard.ingest(chunk);
+    }
+    RankingResult result = leaderboard.finish();
+    result.metrics_.fetch_ms_ = fetched.fetch_ms_;
+    result.metrics_.stall_ms_ = fetched.stall_ms_;
+    result.metrics_.players_fetched_ = fetched.players_fetched_;
+    result.metrics_.bytes_fetched_ = fetched.bytes_fetched_;
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count() - result.metrics_.fetch_ms_;
+    return result;
+}
+
+Online::WindowedLeaderboard::WindowedLeaderboard(const size_t &r, const size_t &max_players, const Clock::duration &max_age)
+    : r_{r}, max_players_{max_players}, max_age_{max_age}, ingested_{0}, window_start_{0}, head_{0}, filled_{0}, prune_at_{r}, top_{LowerLevelFirst{&players_}},
+      rest_{HigherLevelFirst{&players_}} {
+    if (r == 0) {
+        throw std::invalid_argument("A WindowedLeaderboard must hold at least one Player");
+    }
+    if (max_players == 0 && max_age <= Clock::duration::zero()) {
+        throw std::invalid_argument("A WindowedLeaderboard needs a max_players or max_age window");
+    }
+}
+
+void Online::WindowedLeaderboard::ingest(const Player &player, const Clock::time_point &now) {
+    expire(now);
+    if (max_players_ > 0 && windowSize() == max_players_) {
+        advanceTo(window_start_ + 1);
+    }
+
+    size_t slot;
+    if (free_.empty()) {
+        slot = players_.size();
+        players_.push_back(player);
+        sequences_.push_back(ingested_);
+    } else {
+        slot = free_.back();
+        free_.pop_back();
+        players_[slot] = player;
+        sequences_[slot] = ingested_;
+    }
+    ingested_++;
+    if (max_age_ > Clock::duration::zero()) {
+        arrivals_.push_back(now);
+    }
+    if (filled_ == candidates_.size()) {
+        std::vector<size_t> candidates(std::max<size_t>(16, 2 * candidates_.size()));
+        for (size_t i = 0; i < filled_; ++i) {
+            candidates[i] = candidate(i);
+        }
+        candidates_.swap(candidates);
+        head_ = 0;
+    }
+    candidate(filled_++) = slot;
+
+    if (top_.size() < r_) {
+        top_.push(slot);
+    } else if (player.level_ > players_[top_.top()].level_) {
+        // The new Player displaces the lowest on the leaderboard, who drops to the rest
+        rest_.push(top_.pop());
+        top_.push(slot);
+    } else {
+        rest_.push(slot);
+    }
+    if (rest_.size() >= prune_at_) {
+        prune();
+    }
+}
+
+void Online::WindowedLeaderboard::expire(const Clock::time_point &now) {
+    if (max_age_ <= Clock::duration::zero()) {
+        return;
+    }
+    size_t start = window_start_;
+    while (start - window_start_ < arrivals_.size() && now - arrivals_[start - window_start_] > max_age_) {
+        start++;
+    }
+    advanceTo(start);
+}
+
+void Online::WindowedLeaderboard::advanceTo(const size_t &start) {
+    if (max_age_ > Clock::duration::zero()) {
+        arrivals_.erase(arrivals_.begin(), arrivals_.begin() + (start - window_start_));
+    }
+    window_start_ = start;
+    while (filled_ > 0 && sequences_[candidate(0)] < window_start_) {
+        expireOldest();
+    }
+}
+
+void Online::WindowedLeaderboard::expireOldest() {
+    const size_t slot = candidate(0);
+    head_ = (head_ + 1) & (candidates_.size() - 1);
+    filled_--;
+    if (top_.contains(slot)) {
+        top_.erase(slot);
+        if (!rest_.empty()) {
+            top_.push(rest_.pop());
+        }
+    } else {
+        rest_.erase(slot);
+    }
+    free_.push_back(slot);
+}
+
+void Online::WindowedLeaderboard::prune() {
+    // Newest first, keeping a min-heap of the r highest levels among the candidates seen so far (all newer)
+    std::vector<size_t> &newer = newer_;
+    newer.clear();
+    size_t kept = filled_;
+    for (size_t i = filled_; i-- > 0;) {
+        const size_t slot = candidate(i);
+        const size_t level = players_[slot].level_;
+        if (newer.size() == r_ && level <= newer.front() && rest_.contains(slot)) {
+            rest_.erase(slot);
+            free_.push_back(slot);
+            continue;
+        }
+        candidate(--kept) = slot;
+        if (newer.size() < r_) {
+            newer.push_back(level);
+            pushHeap<2>(newer.begin(), newer.end());
+        } else if (level > newer.front()) {
+            replaceMin<2>(newer.begin(), newer.end(), level);
+        }
+    }
+    head_ = (head_ + kept) & (candidates_.size() - 1);
+    filled_ -= kept;
+    prune_at_ = 4 * rest_.size() + 4 * r_;
+}
+
+size_t Online::WindowedLeaderboard::cutoff() const {
+    return top_.empty() ? 0 : players_[top_.top()].level_;
+}
+
+std::vector<Player> Online::WindowedLeaderboard::snapshot() const {
+    std::vector<Player> top;
+    top.reserve(top_.size());
+    for (const size_t &slot : top_.slots()) {
+        top.push_back(players_[slot]);
+    }
+    std::sort(top.begin(), top.end());
+    return top;
+}
+
+size_t Online::WindowedLeaderboard::size() const {
+    return top_.size();
+}
+
+size_t Online::WindowedLeaderboard::windowSize() const {
+    return ingested_ - window_start_;
+}
+
+size_t Online::WindowedLeaderboard::candidateCount() const {
+    return filled_;
+}
+
+Online::UpdatableLeaderboard::UpdatableLeaderboard(const size_t &r)
+    : r_{r}, top_{LowerLevelFirst{&players_}}, rest_{HigherLevelFirst{&players_}} {
+    if (r == 0) {
+        throw std::invalid_argument("An UpdatableLeaderboard must hold at least one player");
+    }
+}
+
+void Online::UpdatableLeaderboard::upsert(const Player &player) {
+    const auto found = slots_.find(player.id_);
+    if (found != slots_.end()) {
+        players_[found->second] = player;
+        reposition(found->second);
+        return;
+    }
+
+    size_t slot;
+    if (free_.empty()) {
+        slot = players_.size();
+        players_.push_back(player);
+    } else {
+        slot = free_.back();
+        free_.pop_back();
+        players_[slot] = player;
+    }
+    slots_.emplace(player.id_, slot);
+
+    if (top_.size() < r_) {
+        top_.push(slot);
+    } else if (player.level_ > players_[top_.top()].level_) {
+        rest_.push(top_.pop());
+        top_.push(slot);
+    } else {
+        rest_.push(slot);
+    }
+}
+
+void Online::UpdatableLeaderboard::updateLevel(const size_t &id, const size_t &level) {
+    const size_t slot = slots_.at(id);
+    players_[slot].level_ = level;
+    reposition(slot);
+}
+
+void Online::UpdatableLeaderboard::reposition(const size_t &slot) {
+    if (top_.contains(slot)) {
+        top_.update(slot);
+    } else {
+        rest_.update(slot);
+    }
+
+    // A single change can only push one player across the cutoff
+    if (!rest_.empty() && players_[rest_.top()].level_ > players_[top_.top()].level_) {
+        const size_t promoted = rest_.pop();
+        rest_.push(top_.pop());
+        top_.push(promoted);
+    }
+}
+
+bool Online::UpdatableLeaderboard::erase(const size_t &id) {
+    const auto found = slots_.find(id);
+    if (found == slots_.end()) {
+        return false;
+    }
+
+    const size_t slot = found->second;
+    slots_.erase(found);
+    if (top_.contains(slot)) {
+        top_.erase(slot);
+        if (!rest_.empty()) {
+            top_.push(rest_.pop());
+        }
+    } else {
+        rest_.erase(slot);
+    }
+    free_.push_back(slot);
+    return true;
+}
+
+bool Online::UpdatableLeaderboard::contains(const size_t &id) const {
+    return slots_.count(id) > 0;
+}
+
+const Player &Online::UpdatableLeaderboard::at(const size_t &id) const {
+    return players_[slots_.at(id)];
+}
+
+size_t Online::UpdatableLeaderboard::cutoff() const {
+    return top_.empty() ? 0 : players_[top_.top()].level_;
+}
+
+std::vector<Player> Online::UpdatableLeaderboard::snapshot() const {
+    std::vector<Player> top;
+    top.reserve(top_.size());
+    for (const size_t &slot : top_.slots()) {
+        top.push_back(players_[slot]);
+    }
+    std::sort(top.begin(), top.end());
+    return top;
+}
+
+size_t Online::UpdatableLeaderboard::size() const {
+    return top_.size();
+}
+
+size_t Online::UpdatableLeaderboard::playerCount() const {
+    return slots_.size();
+}
+
+RankingResult Online::rankUpdates(PlayerStream &stream, const size_t &reporting_interval) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    RankingResult result({}, CutoffSeries(reporting_interval));
+    UpdatableLeaderboard leaderboard(reporting_interval);
+    size_t count = 0;
+    ChunkFetcher fetcher(stream, result.metrics_);
+    for (PlayerChunk chunk = fetcher.next(); !chunk.empty(); chunk = fetcher.next()) {
+        for (const Player &player : chunk) {
+            leaderboard.upsert(player);
+            if (++count % reporting_interval == 0) {
+                result.cutoffs_.record(count, leaderboard.cutoff());
+            }
+        }
+    }
+    if (count % reporting_interval != 0) {
+        result.cutoffs_.record(count, leaderboard.cutoff());
+    }
+    result.top_ = leaderboard.snapshot();
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count() - result.metrics_.fetch_ms_;
+    return result;
+}
+
+/**
+ * @brief A multi-threaded version of rankIncoming(): workers keep local top-<reporting_interval>
+ *        heaps of their slice of every interval, which are merged into the leaderboard
+ *        at each interval boundary.
+ *
+ * @param stream A stream providing Player objects
+ * @param reporting_interval The frequency at which to record cutoff levels
+ * @param threads The number of worker threads; 0 is treated as 1
+ * @return A RankingResult as returned by rankIncoming()
+ *
+ * @post All elements of the stream are read until there are none remaining.
+ */
+RankingResult Online::parallelRankIncoming(PlayerStream &stream, const size_t &reporting_interval, unsigned threads) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+    RankingResult result;
+    result.cutoffs_ = CutoffSeries(reporting_interval);
+    const size_t r = reporting_interval;
+    const unsigned workers = std::max(1u, threads);
+    const size_t intervals = std::max<size_t>(1, ROUND_SIZE / r);
+    const size_t capacity = intervals * r;
+    size_t count = 0;
+
+    std::vector<Player> topReportPlayers;
+    topReportPlayers.reserve(r);
+    std::vector<Player> round;
+    std::vector<std::vector<RankKey>> local(intervals * workers); // local[j * workers + w]: worker w's heap for interval j
+
+    ChunkFetcher fetcher(stream, result.metrics_);
+    while (true) {
+        // Copy-assigning into the previous round's Players reuses their names' buffers
+        size_t filled = 0;
+        for (PlayerChunk chunk; filled < capacity && !(chunk = fetcher.next(std::min(CHUNK_SIZE, capacity - filled))).empty();) {
+            if (round.size() < filled + chunk.size()) {
+                round.resize(filled + chunk.size());
+            }
+            std::copy(chunk.begin(), chunk.end(), round.begin() + filled);
+            filled += chunk.size();
+        }
+        if (filled == 0) {
+            break;
+        }
+
+        // The leaderboard's minimum only rises, so nobody at or below it now can be admitted this round
+        const bool full = topReportPlayers.size() == r;
+        const size_t threshold = full ? topReportPlayers[0].level_ : 0;
+        const size_t roundIntervals = (filled + r - 1) / r;
+
+        forEachThread(workers, [&](unsigned w) {
+            for (size_t j = 0; j < roundIntervals; ++j) {
+                const size_t start = j * r, size = std::min(r, filled - start);
+                const size_t low = start + size * w / workers, high = start + size * (w + 1) / workers;
+
+                std::vector<RankKey> &heap = local[j * workers + w];
+                heap.clear();
+                for (size_t i = low; i < high; ++i) {
+                    const size_t level = round[i].level_;
+                    if (full && level <= threshold) {
+                        continue;
+                    }
+
+                    if (heap.size() < r) {
+                        heap.push_back({level, i});
+                        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                    } else if (level > heap[0].level_) {
+                        RankKey key{level, i};
+                        replaceMin(heap.begin(), heap.end(), key);
+                    }
+                }
+            }
+        });
+
+        for (size_t j = 0; j < roundIntervals; ++j) {
+            for (unsigned w = 0; w < workers; ++w) {
+                for (const RankKey &key : local[j * workers + w]) {
+                    if (topReportPlayers.size() < r) {
+                        topReportPlayers.push_back(round[key.index_]);
+                        std::push_heap(topReportPlayers.begin(), topReportPlayers.end(), std::greater<>());
+                    } else if (key.level_ > topReportPlayers[0].level_) {
+                        replaceMin(topReportPlayers.begin(), topReportPlayers.end(), std::as_const(round[key.index_]));
+                    }
+                }
+            }
+
+            // Only the stream's final interval can be partial, so this also records the final count
+            count += std::min(r, filled - j * r);
+            if (topReportPlayers.empty() == false) {
+                result.cutoffs_.record(count, topReportPlayers[0].level_);
+            }
+        }
+    }
+
+    std::sort(topReportPlayers.begin(), topReportPlayers.end());
+    result.top_ = std::move(topReportPlayers);
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count() - result.metrics_.fetch_ms_;
+    return result;
+}
+
+namespace {
+/**
+ * @brief Backend::Keys version of rankIncoming(): the D-ary min-heap holds RankKeys into
+ *        a fixed pool of Players, so admitting a Player only percolates its key.
+ */
+template <unsigned D>
+RankingResult rankIncomingDary(PlayerStream &stream, const size_t &reporting_interval) {
+    using namespace Online;
+    const auto t1 = std::chrono::high_resolution_clock::now();
+    RankingResult result;
+    result.cutoffs_ = CutoffSeries(reporting_interval);
+    RankingMetrics &metrics = result.metrics_;
+    size_t count = 0;
+
+    // Counts the heap's comparisons when METRICS_ENABLED, & is plain `<` otherwise
+    auto less = [&metrics](const RankKey &lhs, const RankKey &rhs) {
+        if constexpr (METRICS_ENABLED) {
+            metrics.comparisons_++;
+        }
+        return lhs < rhs;
+    };
+
+    // Pad the front so the root ends a cache line & each node's children start one
+    constexpr size_t PAD = CACHE_LINE / sizeof(RankKey) - 1;
+    std::vector<Player> pool;
+    std::vector<RankKey, CacheAlignedAllocator<RankKey>> keys(PAD);
+    pool.reserve(reporting_interval);
+    keys.reserve(PAD + reporting_interval);
+    const auto heap = keys.begin() + PAD;
+    ChunkFetcher fetcher(stream, metrics);
+    for (PlayerChunk chunk = fetcher.next(); !chunk.empty(); chunk = fetcher.next()) {
+        const Player *curr = chunk.begin();
+        while (curr != chunk.end()) {
+            const size_t untilReport = reporting_interval - count % reporting_interval;
+            const Player *segmentEnd = curr + std::min<size_t>(untilReport, chunk.end() - curr);
+            count += segmentEnd - curr;
+
+            std::chrono::high_resolution_clock::time_point s1, s2;
+            if constexpr (METRICS_ENABLED) {
+                s1 = std::chrono::high_resolution_clock::now();
+            }
+            for (; curr != segmentEnd && pool.size() < reporting_interval; ++curr) {
+                keys.push_back({curr->level_, pool.size()});
+                pool.push_back(*curr);
+                pushHeap<D>(heap, keys.end(), less);
+            }
+
+            if constexpr (METRICS_ENABLED) {
+                s2 = std::chrono::high_resolution_clock::now();
+            }
+            if (curr != segmentEnd) {
+                if constexpr (METRICS_ENABLED) {
+                    metrics.comparisons_ += segmentEnd - curr; // findAbove() checks each Player against the cutoff once
+                }
+                curr = findAbove(curr, segmentEnd, heap->level_);
+                for (; curr != segmentEnd; curr = findAbove(curr + 1, segmentEnd, heap->level_)) {
+                    // Reuse the evicted Player's slot, which also reuses its name's buffer
+                    const size_t slot = heap->index_;
+                    pool[slot] = *curr;
+                    replaceMin<D>(heap, keys.end(), RankKey{curr->level_, slot}, less);
+                    if constexpr (METRICS_ENABLED) {
+                        metrics.replacements_++;
+                    }
+                }
+            }
+            if constexpr (METRICS_ENABLED) {
+                const std::chrono::duration<double, std::milli> build = s2 - s1, replace = std::chrono::high_resolution_clock::now() - s2;
+                metrics.build_ms_ += build.count();
+                metrics.replace_ms_ += replace.count();
+            }
+
+            if (count % reporting_interval == 0 && pool.empty() == false) {
+                result.cutoffs_.record(count, heap->level_);
+            }
+        }
+    }
+    if (count % reporting_interval != 0 && pool.empty() == false) {
+        result.cutoffs_.record(count, heap->level_);
+    }
+
+    const auto s3 = std::chrono::high_resolution_clock::now();
+    std::sort(heap, keys.end());
+    const std::chrono::duration<double, std::milli> sort = std::chrono::high_resolution_clock::now() - s3;
+    if constexpr (METRICS_ENABLED) {
+        metrics.sort_ms_ = sort.count();
+    }
+    result.top_.reserve(pool.size());
+    for (auto key = heap; key != keys.end(); ++key) {
+        result.top_.push_back(std::move(pool[key->index_]));
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count() - metrics.fetch_ms_;
+    return result;
+}
+} // namespace
+
+RankingResult Online::rankIncomingKeys(PlayerStream &stream, const size_t &reporting_interval, unsigned arity) {
+    switch (arity) {
+    case 2:
+        return rankIncomingDary<2>(stream, reporting_interval);
+    case 4:
+        return rankIncomingDary<4>(stream, reporting_interval);
+    case 8:
+        return rankIncomingDary<8>(stream, reporting_interval);
+    default:
+        throw std::invalid_argument("rankIncomingKeys() supports heaps of arity 2, 4 or 8, not " + std::to_string(arity));
+    }
+}
+
+RankingResult Online::rankIncomingStable(PlayerStream &stream, const size_t &reporting_interval, TieBreak tie_break) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+    RankingResult result;
+    result.cutoffs_ = CutoffSeries(reporting_interval);
+    size_t count = 0;
+
+    std::vector<Player> pool;
+    std::vector<StableKey> heap; // A min-heap, whose root is the Player that is evicted next
+    pool.reserve(reporting_interval);
+    heap.reserve(reporting_interval);
+    ChunkFetcher fetcher(stream, result.metrics_);
+    for (PlayerChunk chunk = fetcher.next(); !chunk.empty(); chunk = fetcher.next()) {
+        const Player *curr = chunk.begin();
+        while (curr != chunk.end()) {
+            const size_t untilReport = reporting_interval - count % reporting_interval;
+            const Player *segmentEnd = curr + std::min<size_t>(untilReport, chunk.end() - curr);
+            const size_t segmentStart = count - (curr - chunk.begin());
+            auto tie = [&](const Player *player) { return tie_break == TieBreak::Id ? player->id_ : segmentStart + (player - chunk.begin()); };
+            count += segmentEnd - curr;
+
+            for (; curr != segmentEnd && pool.size() < reporting_interval; ++curr) {
+                heap.push_back({packStableKey(curr->level_, tie(curr)), pool.size()});
+                pool.push_back(*curr);
+                pushHeap<2>(heap.begin(), heap.end());
+            }
+
+            // By position, anyone tied with the root arrived later, so has the lower key & can be skipped too
+            auto nextCandidate = [&](const Player *from) {
+                const size_t level = heap.front().level();
+                if (tie_break == TieBreak::Position) {
+                    return findAbove(from, segmentEnd, level);
+                }
+                return level == 0 ? from : findAbove(from, segmentEnd, level - 1);
+            };
+            if (curr != segmentEnd) {
+                for (curr = nextCandidate(curr); curr != segmentEnd; curr = nextCandidate(curr + 1)) {
+                    const StableKey key{packStableKey(curr->level_, tie(curr)), heap.front().index_};
+                    if (heap.front() < key) {
+                        pool[key.index_] = *curr;
+                        replaceMin<2>(heap.begin(), heap.end(), key);
+                    }
+                }
+            }
+
+            if (count % reporting_interval == 0 && pool.empty() == false) {
+                result.cutoffs_.record(count, heap.front().level());
+            }
+        }
+    }
+    if (count % reporting_interval != 0 && pool.empty() == false) {
+        result.cutoffs_.record(count, heap.front().level());
+    }
+
+    std::sort(heap.begin(), heap.end());
+    result.top_.reserve(pool.size());
+    for (const StableKey &key : heap) {
+        result.top_.push_back(std::move(pool[key.index_]));
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count() - result.metrics_.fetch_ms_;
+    return result;
+}
+
+Online::FlatPartitionMap::FlatPartitionMap()
+    : entries_(16, Entry{0, EMPTY}), mask_{15}, size_{0} {
+}
+
+void Online::FlatPartitionMap::insert(const uint64_t &key, const uint32_t &slot) {
+    if (2 * (size_ + 1) > entries_.size()) {
+        std::vector<Entry> old(2 * entries_.size(), Entry{0, EMPTY});
+        old.swap(entries_);
+        mask_ = entries_.size() - 1;
+        size_ = 0;
+        for (const Entry &entry : old) {
+            if (entry.slot_ != EMPTY) {
+                insert(entry.key_, entry.slot_);
+            }
+        }
+    }
+    size_t i = hash(key) & mask_;
+    while (entries_[i].slot_ != EMPTY) {
+        i = (i + 1) & mask_;
+    }
+    entries_[i] = {key, slot};
+    size_++;
+}
+
+size_t Online::FlatPartitionMap::size() const {
+    return size_;
+}
+
+const RankingResult &Online::PartitionedRankingResult::at(const uint64_t &partition) const {
+    const auto found = std::lower_bound(partitions_.begin(), partitions_.end(), partition,
+                                        [](const std::pair<uint64_t, RankingResult> &entry, const uint64_t &key) { return entry.first < key; });
+    if (found == partitions_.end() || found->first != partition) {
+        throw std::out_of_range("No Player was routed to partition " + std::to_string(partition));
+    }
+    return found->second;
+}
+
+Online::PartitionedLeaderboard::PartitionedLeaderboard(const size_t &reporting_interval)
+    : reporting_interval_{reporting_interval}, count_{0} {
+    if (reporting_interval_ == 0) {
+        throw std::invalid_argument("A PartitionedLeaderboard needs a positive reporting interval");
+    }
+}
+
+uint32_t Online::PartitionedLeaderboard::addPartition(const uint64_t &partition) {
+    if (partitions_.size() >= FlatPartitionMap::EMPTY) {
+        throw std::length_error("A PartitionedLeaderboard holds at most 2^32 - 1 partitions");
+    }
+    const uint32_t slot = partitions_.size();
+    partitions_.push_back({keys_.size(), 0, 0, reporting_interval_, 0});
+    ids_.push_back(partition);
+    cutoffs_.emplace_back(reporting_interval_);
+    keys_.resize(keys_.size() + reporting_interval_);
+    pool_.resize(pool_.size() + reporting_interval_);
+    map_.insert(partition, slot);
+    return slot;
+}
+
+void Online::PartitionedLeaderboard::admit(Partition &target, const Player &player) {
+    const KeyIt heap = keys_.begin() + target.base_;
+    if (target.size_ < reporting_interval_) {
+        const size_t slot = target.base_ + target.size_++;
+        pool_[slot] = player;
+        heap[target.size_ - 1] = {player.level_, slot};
+        pushHeap<2>(heap, heap + target.size_);
+    } else {
+        // Reuse the evicted Player's slot, which also reuses its name's buffer
+        const size_t slot = heap->index_;
+        pool_[slot] = player;
+        replaceMin<2>(heap, heap + target.size_, RankKey{player.level_, slot});
+    }
+    target.cutoff_ = heap->level_;
+}
+
+void Online::PartitionedLeaderboard::report(const uint32_t &slot) {
+    Partition &target = partitions_[slot];
+    target.count_ += reporting_interval_;
+    target.until_report_ = reporting_interval_;
+    count_ += reporting_interval_;
+    cutoffs_[slot].record(target.count_, target.cutoff_);
+}
+
+size_t Online::PartitionedLeaderboard::cutoff(const uint64_t &partition) const {
+    const uint32_t slot = map_.find(partition);
+    if (slot == FlatPartitionMap::EMPTY || partitions_[slot].size_ == 0) {
+        return 0;
+    }
+    return partitions_[slot].cutoff_;
+}
+
+size_t Online::PartitionedLeaderboard::partitionCount() const {
+    return partitions_.size();
+}
+
+size_t Online::PartitionedLeaderboard::count() const {
+    size_t count = count_;
+    for (const Partition &partition : partitions_) {
+        count += reporting_interval_ - partition.until_report_;
+    }
+    return count;
+}
+
+Online::PartitionedRankingResult Online::PartitionedLeaderboard::finish() {
+    std::vector<uint32_t> order(partitions_.size());
+    for (uint32_t slot = 0; slot < order.size(); ++slot) {
+        order[slot] = slot;
+    }
+    std::sort(order.begin(), order.end(), [this](const uint32_t &lhs, const uint32_t &rhs) { return ids_[lhs] < ids_[rhs]; });
+
+    PartitionedRankingResult result;
+    result.partitions_.reserve(order.size());
+    for (const uint32_t &slot : order) {
+        const Partition &partition = partitions_[slot];
+        const size_t count = partition.count_ + (reporting_interval_ - partition.until_report_);
+        if (count != partition.count_) {
+            cutoffs_[slot].record(count, partition.cutoff_);
+        }
+
+        const KeyIt heap = keys_.begin() + partition.base_;
+        std::sort(heap, heap + partition.size_);
+        std::vector<Player> top;
+        top.reserve(partition.size_);
+        for (KeyIt key = heap; key != heap + partition.size_; ++key) {
+            top.push_back(std::move(pool_[key->index_]));
+        }
+        result.partitions_.emplace_back(ids_[slot], RankingResult(std::move(top), std::move(cutoffs_[slot])));
+    }
+
+    count_ = 0;
+    map_ = FlatPartitionMap();
+    partitions_.clear();
+    ids_.clear();
+    cutoffs_.clear();
+    keys_.clear();
+    pool_.clear();
+    return result;
+}
+
+// Helper Functions For quickSelectRank
+int Offline::choosePivot(std::vector<Player> &players, int low, int high) {
+    return choosePivot(players, low, high, ByLevel{}, std::less<>{});
+}
+
+std::pair<int, int> Offline::partition(std::vector<Player> &players, int low, int high, int pivot) {
+    return partition(players, low, high, pivot, ByLevel{}, std::less<>{});
+}
+
+int Offline::depthLimit(int low, int high) {
+    int depth = 0;
+    for (int size = high - low + 1; size > 1; size >>= 1) {
+        depth += 2;
+    }
+    return depth;
+}
+
+void Offline::heapSelect(std::vector<Player> &players, int low, int high, int k) {
+    heapSelect(players, low, high, k, ByLevel{}, std::less<>{});
+}
+
+void Offline::quickSort(std::vector<Player> &players, int low, int high) {
+    quickSort(players, low, high, depthLimit(low, high));
+}
+
+void Offline::quickSort(std::vector<Player> &players, int low, int high, int depth) {
+    quickSort(players, low, high, depth, ByLevel{}, std::less<>{});
+}
+
+void Offline::quickSelect(std::vector<Player> &players, int low, int high, int k) {
+    quickSelect(players, low, high, k, ByLevel{}, std::less<>{});
+}
+
+void Offline::multiQuickSelect(std::vector<Player> &players, int low, int high, const int *first, const int *last, int depth) {
+    while (first != last && low < high) {
+        if (depth-- == 0) {
+            // Leaves players[*first..high] sorted, which places every remaining index
+            heapSelect(players, low, high, *first);
+            return;
+        }
+
+        const auto [lower, upper] = partition(players, low, high, choosePivot(players, low, high));
+        const int *middle = std::lower_bound(first, last, lower);
+        const int *above = std::upper_bound(middle, last, upper);
+        multiQuickSelect(players, low, lower - 1, first, middle, depth);
+        low = upper + 1;
+        first = above;
+    }
+}
+
+MultiSelectResult Offline::multiSelect(std::vector<Player> &players, const std::vector<double> &fractions, Transfer transfer) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const int size = players.size();
+    std::vector<int> firsts; // The index of the lowest Player in each fraction's top
+    for (const double &fraction : fractions) {
+        if (!(fraction >= 0 && fraction <= 1)) {
+            throw std::invalid_argument("Top fractions must be within [0, 1], got " + std::to_string(fraction));
+        }
+        firsts.push_back(size - static_cast<int>(std::floor(fraction * size)));
+    }
+
+    std::vector<int> positions;
+    for (const int &first : firsts) {
+        if (first < size) {
+            positions.push_back(first);
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    multiQuickSelect(players, 0, size - 1, positions.data(), positions.data() + positions.size(), depthLimit(0, size - 1));
+
+    MultiSelectResult result;
+    for (const int &first : firsts) {
+        result.cutoffs_.push_back(first < size ? players[first].level_ : 0);
+    }
+    const int top = firsts.empty() ? size : *std::max_element(firsts.begin(), firsts.end());
+    if (top < size) {
+        quickSort(players, top, size - 1);
+        result.top_ = transferRange(players.begin() + top, players.end(), transfer);
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
 }
@@ -2,14 +2,261 @@
 #include "Player.hpp"
 #include "PlayerStream.hpp"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
 #include <ratio>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+/**
+ * @brief An ordered, vector-backed history of leaderboard cutoffs, keyed by Player count.
+ *
+ * Cutoffs are recorded every <interval> Players, so the cutoff after `k * interval` Players
+ * is stored densely at index k - 1; one extra tail entry holds the cutoff after a final
+ * count that is not a multiple of the interval. Appending is O(1) & allocation-free
+ * (amortized), lookups are O(1), & iteration is in increasing count order.
+ *
+ * Read access mirrors the std::unordered_map<size_t, size_t> this replaces (size(), count(), at(), find(),
+ * operator[], == in either order), so legacy readers compile unchanged. A map converts to a series
+ * implicitly, but the O(n) conversion back to a map must be asked for, through toMap() or explicitly.
+ *
+ * @example With an interval of 50 & 132 Players read, this holds { 50: 239, 100: 992, 132: 994 }:
+ * levels_ = { 239, 992 }, & the tail entry is (132, 994).
+ */
+class CutoffSeries {
+private:
+    size_t interval_;
+
+    /**
+     * @brief levels_[i] is the cutoff after (i + 1) * interval_ Players.
+     */
+    std::vector<size_t> levels_;
+
+    /**
+     * @brief The final count that is not a multiple of interval_ & its cutoff, if tail_count_ > 0.
+     */
+    size_t tail_count_;
+    size_t tail_level_;
+
+    /**
+     * @brief Returns the index of the entry recorded for exactly `count`, or size() if there is none.
+     */
+    size_t indexOf(const size_t &count) const;
+
+public:
+    using key_type = size_t;
+    using mapped_type = size_t;
+    using value_type = std::pair<size_t, size_t>;
+
+    /**
+     * @brief An input iterator over (count, cutoff) pairs, in increasing count order.
+     */
+    class const_iterator {
+    private:
+        const CutoffSeries *series_;
+        size_t index_;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::pair<size_t, size_t>;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+
+        /**
+         * @brief Holds the entry an operator-> call points at, as entries are computed rather than stored.
+         */
+        struct pointer {
+            value_type entry_;
+            const value_type *operator->() const { return &entry_; }
+        };
+
+        const_iterator(const CutoffSeries *series, size_t index) : series_{series}, index_{index} {}
+
+        value_type operator*() const { return series_->entry(index_); }
+        pointer operator->() const { return {series_->entry(index_)}; }
+        const_iterator &operator++() { ++index_; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index_; return old; }
+        bool operator==(const const_iterator &rhs) const { return index_ == rhs.index_; }
+        bool operator!=(const const_iterator &rhs) const { return index_ != rhs.index_; }
+    };
+
+    /**
+     * @brief Constructs an empty series recording a cutoff every `interval` Players.
+     */
+    explicit CutoffSeries(const size_t &interval = 0);
+
+    /**
+     * @brief Constructs a series holding the same entries as a legacy cutoff map.
+     *
+     * @throws std::invalid_argument If the keys are not the multiples of the smallest key,
+     *      up to some count, optionally followed by one key below the next multiple.
+     */
+    CutoffSeries(const std::unordered_map<size_t, size_t> &cutoffs);
+
+    /**
+     * @brief Appends the cutoff after `count` Players.
+     *
+     * @pre count is greater than any count recorded so far, & either the next multiple of
+     *      the interval or the final count (recorded last).
+     * @throws std::invalid_argument If `count` is neither.
+     */
+    void record(const size_t &count, const size_t &level);
+
+    /**
+     * @brief Returns the cutoff recorded for exactly `count` Players.
+     *
+     * @throws std::out_of_range If no cutoff was recorded for `count`.
+     */
+    size_t at(const size_t &count) const;
+
+    /**
+     * @brief Returns 1 if a cutoff was recorded for exactly `count` Players, otherwise 0.
+     */
+    size_t count(const size_t &count) const;
+
+    /**
+     * @brief Returns an iterator to the (count, cutoff) entry for exactly `count` Players, or end().
+     */
+    const_iterator find(const size_t &count) const;
+
+    /**
+     * @brief Returns the cutoff recorded for exactly `count` Players, or 0 if there is none,
+     *        as a legacy map's operator[] would read it (without inserting anything).
+     */
+    size_t operator[](const size_t &count) const;
+
+    /**
+     * @brief Returns the cutoff in effect after `count` Players:
+     *        the one recorded at the largest milestone no greater than `count`.
+     *
+     * @throws std::out_of_range If `count` is before the first recorded milestone.
+     */
+    size_t cutoffAt(const size_t &count) const;
+
+    /**
+     * @brief Returns every (count, cutoff) entry with first <= count <= last, in increasing count order.
+     */
+    std::vector<std::pair<size_t, size_t>> range(const size_t &first, const size_t &last) const;
+
+    /**
+     * @brief Returns the i-th (count, cutoff) entry in increasing count order, i < size().
+     */
+    std::pair<size_t, size_t> entry(const size_t &i) const;
+
+    size_t interval() const;
+    size_t size() const;
+    bool empty() const;
+    void clear();
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /**
+     * @brief Converts to the legacy representation of RankingResult::cutoffs_.
+     */
+    std::unordered_map<size_t, size_t> toMap() const;
+    explicit operator std::unordered_map<size_t, size_t>() const;
+
+    /**
+     * @brief Compares the entries held, regardless of representation.
+     */
+    bool operator==(const CutoffSeries &rhs) const;
+    bool operator!=(const CutoffSeries &rhs) const;
+    bool operator==(const std::unordered_map<size_t, size_t> &rhs) const;
+    bool operator!=(const std::unordered_map<size_t, size_t> &rhs) const;
+};
+
+bool operator==(const std::unordered_map<size_t, size_t> &lhs, const CutoffSeries &rhs);
+bool operator!=(const std::unordered_map<size_t, size_t> &lhs, const CutoffSeries &rhs);
+
+/**
+ * @brief Whether the rankings collect their full RankingMetrics, set by building with
+ *        -DLEADERBOARD_METRICS (`make METRICS=1`, or `cmake -DLEADERBOARD_METRICS=ON`).
+ *
+ * The instrumentation is guarded by `if constexpr (METRICS_ENABLED)`, so a default
+ * build compiles it out of the hot loops entirely.
+ */
+#ifdef LEADERBOARD_METRICS
+constexpr bool METRICS_ENABLED = true;
+#else
+constexpr bool METRICS_ENABLED = false;
+#endif
+
+/**
+ * @brief Where an Online ranking spent its time & work.
+ *
+ * fetch_ms_ & stall_ms_ are always filled in, since elapsed_ leaves them out.
+ * Everything else stays 0 unless METRICS_ENABLED, & only Online::rankIncoming() fills in all of it
+ * (swaps_ only for Backend::Objects).
+ */
+struct RankingMetrics {
+    /**
+     * @brief Time spent in stream.nextChunk(), including stall_ms_, in ms.
+     */
+    double fetch_ms_ = 0;
+
+    /**
+     * @brief The part of fetch_ms_ the stream spent blocked waiting for Players (see PlayerStream::stallTime()), in ms.
+     */
+    double stall_ms_ = 0;
+
+    /**
+     * @brief Time spent filling the leaderboard until it first holds reporting_interval Players, in ms.
+     */
+    double build_ms_ = 0;
+
+    /**
+     * @brief Time spent filtering Players against the cutoff & replacing the minimum, once full, in ms.
+     */
+    double replace_ms_ = 0;
+
+    /**
+     * @brief Time spent on the final sort of the leaderboard, in ms.
+     */
+    double sort_ms_ = 0;
+
+    /**
+     * @brief Level comparisons: one per Player filtered against the cutoff, plus the heap's own.
+     */
+    size_t comparisons_ = 0;
+
+    /**
+     * @brief Players moved between heap slots while percolating.
+     */
+    size_t swaps_ = 0;
+
+    /**
+     * @brief Players admitted to a full leaderboard, each evicting its minimum.
+     */
+    size_t replacements_ = 0;
+
+    size_t players_fetched_ = 0;
+
+    /**
+     * @brief The Player data fetched: each Player's level, id & name bytes.
+     */
+    size_t bytes_fetched_ = 0;
+
+    /**
+     * @brief Returns the metrics as a single-line JSON object, eg.
+     * {"fetch_ms":1.2,"stall_ms":0,...,"bytes_fetched":2400000}
+     */
+    std::string toJson() const;
+};
+
 struct RankingResult {
     /**
      * @brief The collection of top-ranked players.
@@ -20,7 +267,7 @@ struct RankingResult {
     std::vector<Player> top_;
 
     /**
-     * @brief Map of player count milestones to their respective minimum level cutoffs.
+     * @brief Series of player count milestones & their respective minimum level cutoffs.
      *
      * Keys represent the number of players processed at a given point,
      * and values represent the minimum level required to be in the leaderboard
@@ -36,27 +283,237 @@ struct RankingResult {
      *   the minimum level to be on the leaderboard is 992.
      *   3) After fetching/processing ALL 132 players,
      *   the minimum level to be on the leaderboard is 994.
+     *
+     * See CutoffSeries for lookups, range queries & conversion to a std::unordered_map.
      */
-    std::unordered_map<size_t, size_t> cutoffs_;
+    CutoffSeries cutoffs_;
 
     /**
      * @brief Represents the total elapsed processing time for the entire ranking operation, in ms.
+     * Online rankings leave out the time spent fetching from the stream (see metrics_).
      */
     double elapsed_;
 
+    /**
+     * @brief The breakdown of an Online ranking's time & work (see RankingMetrics).
+     */
+    RankingMetrics metrics_;
+
     /**
      * @brief Constructor for RankingResult with top players, cutoffs, and elapsed time.
      *
      * @param top Vector of top-ranked Player objects, in sorted order.
-     * @param cutoffs Map of player count thresholds to minimum level cutoffs.
+     * @param cutoffs Series (or legacy map) of player count thresholds to minimum level cutoffs.
      *   NOTE: This is only ever non-empty for Online::rankIncoming().
      *         This parameter & the corresponding member should be empty
      *         for all Offline algorithms.
      * @param elapsed Time taken to calculate the ranking, in ms.
+     *
+     * @note `top` & `cutoffs` are taken by value & moved into place,
+     *       so pass them with std::move() to avoid copying.
+     */
+    RankingResult(std::vector<Player> top = {}, CutoffSeries cutoffs = CutoffSeries(), double elapsed = 0);
+};
+
+/**
+ * @brief A non-owning view of the top players, left sorted (ascending) at the tail
+ *        of the vector an Offline algorithm ranked in place.
+ *
+ * Valid until that vector is modified or destroyed.
+ */
+struct RankingView {
+    std::vector<Player>::iterator begin_;
+    std::vector<Player>::iterator end_;
+
+    /**
+     * @brief The duration (ms) of the selection/sorting operation.
+     */
+    double elapsed_;
+
+    std::vector<Player>::iterator begin() const { return begin_; }
+    std::vector<Player>::iterator end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+    Player &operator[](size_t i) const { return begin_[i]; }
+};
+
+/**
+ * @brief The result of Offline::multiSelect().
+ */
+struct MultiSelectResult {
+    /**
+     * @brief cutoffs_[i] is the lowest level in the top fractions[i] of players, or 0 if that top is empty.
+     */
+    std::vector<size_t> cutoffs_;
+
+    /**
+     * @brief The players in the smallest requested top fraction, in sorted order (ascending).
+     */
+    std::vector<Player> top_;
+
+    /**
+     * @brief The duration (ms) of the selection/sorting operation.
+     */
+    double elapsed_ = 0;
+};
+
+/**
+ * @brief Whether an Offline algorithm copies the top players into RankingResult::top_,
+ *        or moves them out of the ranked vector.
+ */
+enum class Transfer {
+    Copy,
+
+    /**
+     * @brief The moved-from Players left in the ranked vector are valid but unspecified.
+     */
+    Move
+};
+
+/**
+ * @brief Selects what the ranking algorithms compare & move while they work.
+ */
+enum class Backend {
+    /**
+     * @brief Compare & swap whole Player objects (the default).
+     */
+    Objects,
+
+    /**
+     * @brief Rank a compact array of RankKeys & only gather
+     * full Player objects once the top players are known.
+     */
+    Keys
+};
+
+/**
+ * @brief A 16-byte stand-in for a Player, ranked by Backend::Keys.
+ * Ordered on level, like Player itself.
+ */
+struct RankKey {
+    size_t level_;
+
+    /**
+     * @brief The position of the Player this key stands for,
+     * in the ranked vector (Offline) or the leaderboard's storage (Online).
+     */
+    size_t index_;
+
+    bool operator<(const RankKey& rhs) const { return level_ < rhs.level_; }
+    bool operator>(const RankKey& rhs) const { return level_ > rhs.level_; }
+};
+
+/**
+ * @brief A read-only view of `size_` levels spaced `stride_` bytes apart:
+ * either a contiguous level column (eg. a snapshot's) or the level_ members of an array of Players,
+ * so the same selection code can rank both.
+ */
+struct LevelColumn {
+    const unsigned char* first_;
+    size_t stride_;
+    size_t size_;
+
+    LevelColumn(const size_t* levels, const size_t& size)
+        : first_{reinterpret_cast<const unsigned char*>(levels)}, stride_{sizeof(size_t)}, size_{size} {}
+
+    LevelColumn(const Player* players, const size_t& size)
+        : first_{size == 0 ? nullptr : reinterpret_cast<const unsigned char*>(&players->level_)}, stride_{sizeof(Player)}, size_{size} {}
+
+    explicit LevelColumn(const std::vector<Player>& players)
+        : LevelColumn(players.data(), players.size()) {}
+
+    size_t operator[](const size_t& i) const { return *reinterpret_cast<const size_t*>(first_ + i * stride_); }
+};
+
+/**
+ * @brief Selects what the stable rankings (eg. Offline::stableRank()) break level ties by.
+ */
+enum class TieBreak {
+    /**
+     * @brief The earlier Player in the input ranks higher.
+     */
+    Position,
+
+    /**
+     * @brief The Player with the lower id_ ranks higher.
+     */
+    Id
+};
+
+/**
+ * @brief A RankKey under a total order: key_ packs (level << 32) | ~tie, where `tie` is the
+ * Player's input position or id, so one integer comparison orders by level & then breaks ties.
+ * Two Players only compare equal if they share both, so every algorithm ranks them identically.
+ */
+struct StableKey {
+    uint64_t key_;
+
+    /**
+     * @brief As RankKey::index_.
+     */
+    size_t index_;
+
+    bool operator<(const StableKey& rhs) const { return key_ < rhs.key_; }
+    bool operator>(const StableKey& rhs) const { return key_ > rhs.key_; }
+
+    /**
+     * @brief The level packed into key_.
+     */
+    size_t level() const { return key_ >> 32; }
+};
+
+/**
+ * @brief Packs `level` & `tie` into a StableKey::key_.
+ * @throws std::out_of_range If either does not fit in 32 bits.
+ */
+uint64_t packStableKey(const size_t &level, const size_t &tie);
+
+/**
+ * @brief Selects how Offline::rankTopK() finds the top k players.
+ */
+enum class Selection {
+    /**
+     * @brief PartialHeap when k is at most N / PARTIAL_HEAP_DIVISOR, otherwise SelectSort.
+     */
+    Auto,
+
+    /**
+     * @brief Streams the input once through a k-sized min-heap of RankKeys, in O(N log k) & O(k) memory.
+     * The input is left unmodified, & most Players are rejected by a single comparison.
+     */
+    PartialHeap,
+
+    /**
+     * @brief Selects the top k of a RankKey per Player, then sorts them, in O(N + k log k) & O(N) memory.
      */
-    RankingResult(const std::vector<Player> &top = {}, const std::unordered_map<size_t, size_t> &cutoffs = {}, double elapsed = 0);
+    SelectSort
 };
 
+/**
+ * @brief Runs task(i) for every i in [0, count) on its own thread & waits for all of them.
+ */
+template <typename Task>
+void forEachThread(unsigned count, Task task) {
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        workers.emplace_back(task, i);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Copies, or moves, [first, last) into a new vector.
+ */
+template <typename It>
+std::vector<Player> transferRange(It first, It last, Transfer transfer) {
+    if (transfer == Transfer::Move) {
+        return std::vector<Player>(std::make_move_iterator(first), std::make_move_iterator(last));
+    }
+    return std::vector<Player>(first, last);
+}
+
 namespace Offline {
 /**
  * @brief Uses a mixture of quickselect/quicksort to
@@ -64,6 +521,9 @@ namespace Offline {
  *        (excluding the returned RankingResult vector)
  *
  * @param players A reference to the vector of Player objects to be ranked
+ * @param backend Whether to partition the Players themselves, or RankKeys for them
+ *      (see quickSelectRankKeys())
+ * @param transfer Whether top_ is copied from `players` or moved out of it
  * @return A Ranking Result object whose
  * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending)
  * - cutoffs_    -> Is empty
@@ -71,7 +531,20 @@ namespace Offline {
  *
  * @post The order of the parameter vector is modified.
  */
-RankingResult quickSelectRank(std::vector<Player> &players);
+RankingResult quickSelectRank(std::vector<Player> &players, Backend backend = Backend::Objects, Transfer transfer = Transfer::Copy);
+
+/**
+ * @brief Ranks a vector the caller gives up, moving the top players out of it rather than copying them.
+ */
+RankingResult quickSelectRank(std::vector<Player> &&players, Backend backend = Backend::Objects);
+
+/**
+ * @brief The selection/sorting steps of quickSelectRank(), without building a RankingResult.
+ *
+ * @return A view of the top 10% of players, sorted (ascending) in place at the tail of `players`.
+ * @post The order of the parameter vector is modified.
+ */
+RankingView quickSelectRankView(std::vector<Player> &players);
 
 /**
  * @brief Uses an early-stopping version of heapsort to
@@ -79,6 +552,9 @@ RankingResult quickSelectRank(std::vector<Player> &players);
  *        (excluding the returned RankingResult vector)
  *
  * @param players A reference to the vector of Player objects to be ranked
+ * @param backend Whether to heapify the Players themselves, or RankKeys for them
+ *      (see heapRankKeys())
+ * @param transfer Whether top_ is copied from `players` or moved out of it
  * @return A Ranking Result object whose
  * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending)
  * - cutoffs_    -> Is empty
@@ -86,55 +562,1270 @@ RankingResult quickSelectRank(std::vector<Player> &players);
  *
  * @post The order of the parameter vector is modified.
  */
-RankingResult heapRank(std::vector<Player> &players);
-
-// Helper Functions
-int partition(std::vector<Player> &players, int &low, int &high);
-void quickSort(std::vector<Player> &players, int low, int high);
-void quickSelect(std::vector<Player> &players, int low, int high, int k);
-}; // namespace Offline
+RankingResult heapRank(std::vector<Player> &players, Backend backend = Backend::Objects, Transfer transfer = Transfer::Copy);
 
-namespace Online {
-using PlayerIt = std::vector<Player>::iterator;
+/**
+ * @brief Ranks a vector the caller gives up, moving the top players out of it rather than copying them.
+ */
+RankingResult heapRank(std::vector<Player> &&players, Backend backend = Backend::Objects);
 
 /**
- * @brief A helper method that replaces the minimum element
- * in a min-heap with a target value & preserves the heap
- * by percolating the new value down to its correct position.
+ * @brief The selection/sorting steps of heapRank(), without building a RankingResult.
  *
- * Performs in O(log N) time.
+ * Popping the top 10% off a max-heap already leaves them sorted (ascending) at the tail.
  *
- * @pre The range [first, last) is a min-heap.
+ * @return A view of the top 10% of players, sorted (ascending) in place at the tail of `players`.
+ * @post The order of the parameter vector is modified.
+ */
+RankingView heapRankView(std::vector<Player> &players);
+
+/**
+ * @brief Selects & sorts the top 10% of players using up to `threads` threads.
  *
- * @param first An iterator to a vector of Player objects
- *      denoting the beginning of a min-heap
- *      NOTE: Unlike the textbook, this is *not* an empty slot
- *      used to store temporary values. It is the root of the heap.
+ * 1) Splits the input into one contiguous shard per thread, & quick-selects
+ *    each shard's own top 10%-of-the-whole (or the entire shard, if smaller) in parallel.
+ *    Every member of the overall top 10% is in its shard's top, so these are the only candidates.
+ * 2) Gathers the candidates & quick-selects the overall top 10% among them.
+ * 3) Sorts that top in parallel slices, then merges the slices pairwise in parallel rounds.
  *
- * @param last An iterator to a vector of Player objects
- *      denoting one past the end of a min-heap
- *      (i.e. it is not considering a valid index of the heap)
+ * @param players A reference to the vector of Player objects to be ranked
+ * @param threads The number of threads to use; 0 is treated as 1
+ * @param transfer Whether the candidates are copied from `players` or moved out of it
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending),
+ *                  level-for-level identical to quickSelectRank() & heapRank()
+ * - cutoffs_    -> Is empty
+ * - elapsed_    -> Contains the duration (ms) of the selection/sorting operation
  *
- * @param target A reference to a Player object to be inserted into the heap
- * @post
- * - The vector slice denoted from [first,last) is a min-heap
- *   into which `target` has been inserted.
- * - The contents of `target` is not guaranteed to match its original state
- *   (ie. you may move it).
+ * @post The order of the parameter vector is modified.
  */
-void replaceMin(PlayerIt first, PlayerIt last, Player &target);
+RankingResult parallelRank(std::vector<Player> &players, unsigned threads, Transfer transfer = Transfer::Copy);
 
 /**
- * @brief Exhausts a stream of Players (ie. until there are none left) such that we:
- * 1) Maintain a running collection of the <reporting_interval> highest leveled players
- * 2) Record the Player level after reading every <reporting_interval> players
- *    representing the minimum level required to be in the leaderboard at that point.
+ * @brief Selects & sorts the top 10% of players under a total order, breaking level ties by `tie_break`,
+ *        so the result is the same for any number of threads & any other stable ranking of the input.
+ *
+ * Selects over a StableKey per Player, sharded across threads as in parallelRank(),
+ * then gathers the top Players in key order.
+ *
+ * @param players A reference to the vector of Player objects to be ranked
+ * @param tie_break What ties are broken by; with TieBreak::Id, equal (level, id) pairs still tie
+ * @param threads The number of threads to use; 0 is treated as 1
+ * @param transfer Whether top_ is copied from `players` or moved out of it
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending),
+ *                  level-for-level identical to quickSelectRank(), with tied Players ranking higher
+ *                  the earlier (or lower-id) they are, ie. later in top_
+ * - cutoffs_    -> Is empty
+ * - elapsed_    -> Contains the duration (ms) of the selection/sorting operation
+ *
+ * @throws std::out_of_range If a level, or the position or id ties are broken by, does not fit in 32 bits.
+ * @post The order of the parameter vector is unchanged.
+ */
+RankingResult stableRank(std::vector<Player> &players, TieBreak tie_break = TieBreak::Position, unsigned threads = 1, Transfer transfer = Transfer::Copy);
+
+/**
+ * @brief rank() uses countingRank() when the highest level is below this (& at most the number of players).
+ */
+constexpr size_t COUNTING_LEVEL_THRESHOLD = 1 << 16;
+
+/**
+ * @brief Selects & sorts the top 10% of players by counting levels, in O(N + K) for levels in [0, K).
+ *
+ * 1) Histograms the levels, then walks the histogram down from the highest level
+ *    to find the cutoff level the top 10% reaches.
+ * 2) Counting-sorts every Player above the cutoff, & as many at it as are needed,
+ *    straight into top_. Players of equal level keep their input order.
+ *
+ * @param players A reference to the vector of Player objects to be ranked
+ * @param transfer Whether top_ is copied from `players` or moved out of it
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the top 10% of players from the input in sorted order (ascending),
+ *                  level-for-level identical to heapRank()
+ * - cutoffs_    -> Is empty
+ * - elapsed_    -> Contains the duration (ms) of the selection/sorting operation
+ *
+ * @note Uses O(K) extra memory, where K is the highest level, so only suits bounded levels.
+ * @post The parameter vector is left unmodified, unless transfer is Transfer::Move.
+ * @throws std::invalid_argument If a level is COUNTING_LEVEL_THRESHOLD or more.
+ */
+RankingResult countingRank(std::vector<Player> &players, Transfer transfer = Transfer::Copy);
+
+/**
+ * @brief Ranks the top 10% of players with whichever algorithm suits their levels:
+ *        countingRank() when the highest level is below COUNTING_LEVEL_THRESHOLD & the number of players,
+ *        quickSelectRank() otherwise.
+ *
+ * @return As countingRank() / quickSelectRank(), which agree level-for-level.
+ * @post The order of the parameter vector may be modified.
+ */
+RankingResult rank(std::vector<Player> &players, Transfer transfer = Transfer::Copy);
+
+/**
+ * @brief Selection::Auto uses a partial heap for k up to N / PARTIAL_HEAP_DIVISOR.
+ *
+ * Measured with `./bench --suite topk` on 1M uniform players: the partial heap
+ * is about 3x faster at k = 0.01% (4 vs. 14 ms), breaks even near k = 2.5% (16 ms each),
+ * & is 2-2.5x slower from 10% up, where its admissions cost O(log k) each.
+ * Ascending input is its worst case, since every Player is admitted.
+ */
+constexpr size_t PARTIAL_HEAP_DIVISOR = 40;
+
+/**
+ * @brief Selects & sorts the top `k` players.
+ *
+ * @param players A reference to the vector of Player objects to be ranked
+ * @param k The number of players to return; more than players.size() returns them all
+ * @param selection How to find them (see Selection)
+ * @param transfer Whether top_ is copied from `players` or moved out of it
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the top min(k, N) players from the input in sorted order (ascending)
+ * - cutoffs_    -> Is empty
+ * - elapsed_    -> Contains the duration (ms) of the selection/sorting operation
+ *
+ * @post The parameter vector is left unmodified, unless transfer is Transfer::Move.
+ */
+RankingResult rankTopK(std::vector<Player> &players, const size_t &k, Selection selection = Selection::Auto, Transfer transfer = Transfer::Copy);
+
+/**
+ * @brief Selects & sorts the top floor(fraction * N) players, as rankTopK().
+ *
+ * @throws std::invalid_argument If `fraction` is not within [0, 1].
+ */
+RankingResult rankTopFraction(std::vector<Player> &players, const double &fraction, Selection selection = Selection::Auto,
+                              Transfer transfer = Transfer::Copy);
+
+/**
+ * @brief The number of buckets in externalRank()'s level histogram: one per level below 1024,
+ *        then 512 per power of two above it, so any level's bucket is within 0.2% of it.
+ */
+constexpr size_t EXTERNAL_BUCKETS = 55 * 1024;
+
+/**
+ * @brief Returns the externalRank() histogram bucket of `level`. Higher levels never map to lower buckets.
+ */
+size_t externalBucket(const size_t &level);
+
+/**
+ * @brief Selects & sorts the top 10% of players from a dataset too large to hold in memory,
+ *        reading it twice through two PlayerStreams over the same Players.
+ *
+ * 1) Histograms every level of `first` into EXTERNAL_BUCKETS buckets, then walks the histogram
+ *    down to the bucket the top 10% ends in.
+ * 2) Streams `second`, keeping every Player above that bucket (all of them are in the top),
+ *    & the highest of those inside it, in a min-heap bounded by the number still needed.
+ *    Finally, sorts what was kept.
+ *
+ * Uses O(top + EXTERNAL_BUCKETS) memory, however many Players the streams hold.
+ *
+ * @param first A stream of the Players to rank, read to the end
+ * @param second Another stream of the same Players in the same order, read to the end
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the top 10% of players in sorted order (ascending),
+ *                  level-for-level identical to quickSelectRank()
+ * - cutoffs_    -> Is empty
+ * - elapsed_    -> Contains the duration (ms) of both passes
+ *
+ * @throws std::invalid_argument If the streams do not hold the same number of Players.
+ * @throws std::runtime_error If `second` holds different levels than `first`.
+ */
+RankingResult externalRank(PlayerStream &first, PlayerStream &second);
+
+/**
+ * @brief The Backend::Keys versions of quickSelectRank() & heapRank().
+ *
+ * Both build one RankKey per Player, select & sort the top 10% of keys
+ * (with std::nth_element / heap operations respectively),
+ * then copy (or move) the matching Players into top_.
+ *
+ * @post The parameter vector is left unmodified, unless transfer is Transfer::Move.
+ */
+RankingResult quickSelectRankKeys(std::vector<Player> &players, Transfer transfer = Transfer::Copy);
+RankingResult heapRankKeys(std::vector<Player> &players, Transfer transfer = Transfer::Copy);
+
+/**
+ * @brief heapRank() over CompactPlayers (see compact()): the heap moves 16-byte records
+ *        rather than 48-byte Players, & only the top 10% are expanded back into Players.
+ *
+ * @param names The table `players` were interned into
+ * @return A Ranking Result object as heapRank()'s
+ * @post The order of the parameter vector is modified.
+ */
+RankingResult heapRankCompact(std::vector<CompactPlayer> &players, const NameTable &names = NameTable::shared());
+
+/**
+ * @brief Returns RankKeys for every Player in `players`, indexed by position.
+ */
+std::vector<RankKey> makeKeys(const std::vector<Player> &players);
+std::vector<RankKey> makeKeys(const LevelColumn &levels);
+
+/**
+ * @brief The RankKeys of the top `k` levels in `levels`, sorted by level & then index,
+ *        found by counting as countingRank() does, in O(N + K) time & O(K) extra memory.
+ *
+ * @pre 0 < k <= levels.size_, & maxLevel is the highest level in the column.
+ */
+std::vector<RankKey> countTopKeys(const LevelColumn &levels, const size_t &k, const size_t &maxLevel);
+
+/**
+ * @brief The RankKeys of the top `k` levels in `levels`, sorted by level, found by
+ *        rankTopK()'s partial heap: O(N + A log k) for A admissions, in O(k) memory.
+ *
+ * @pre 0 < k <= levels.size_.
+ */
+std::vector<RankKey> heapTopKeys(const LevelColumn &levels, const size_t &k);
+
+// Helper Functions
+/**
+ * @brief Ranges at least this long pivot on Tukey's ninther instead of a median of three.
+ */
+constexpr int NINTHER_THRESHOLD = 128;
+
+/**
+ * @brief Returns the index of a pivot for players[low..high]: the median of three
+ * (first, middle, last), or of three such medians for ranges of NINTHER_THRESHOLD or more.
+ */
+int choosePivot(std::vector<Player> &players, int low, int high);
+
+/**
+ * @brief Three-way (Dutch national flag) partition of players[low..high] around the level of players[pivot].
+ *
+ * @return The range [first, second] holding every Player whose level equals the pivot's.
+ *  Everything before it is lower & everything after it is higher.
+ */
+std::pair<int, int> partition(std::vector<Player> &players, int low, int high, int pivot);
+
+/**
+ * @brief Returns the number of partitioning rounds allowed on players[low..high]
+ * before falling back to heap operations, 2 * floor(log2(N)).
+ */
+int depthLimit(int low, int high);
+
+/**
+ * @brief Places the (k - low)-th smallest Player of players[low..high] at index k using
+ * heap operations, with players[k..high] sorted ascending. O(N + (high - k) log N).
+ */
+void heapSelect(std::vector<Player> &players, int low, int high, int k);
+
+/**
+ * @brief Sorts players[low..high] ascending by level.
+ * Recurses on the smaller side of each partition & loops on the larger, so the stack
+ * stays O(log N) deep, & switches to heapsort once `depth` partitions have been spent.
+ */
+void quickSort(std::vector<Player> &players, int low, int high);
+void quickSort(std::vector<Player> &players, int low, int high, int depth);
+
+/**
+ * @brief Rearranges players[low..high] so that players[k] holds the Player that would be
+ * there if the range were sorted, with lower levels before & higher levels after it.
+ * Iterative, falling back to heapSelect() once depthLimit() partitions have been spent.
+ */
+void quickSelect(std::vector<Player> &players, int low, int high, int k);
+
+/**
+ * @brief The helpers above, ordering Players by compare(projection(lhs), projection(rhs))
+ *        rather than by level. The non-template versions are these with ByLevel & std::less<>.
+ */
+template <typename Projection, typename Compare>
+int choosePivot(std::vector<Player> &players, int low, int high, Projection projection, Compare compare) {
+    auto median = [&](int a, int b, int c) {
+        const auto x = projection(players[a]), y = projection(players[b]), z = projection(players[c]);
+        if (compare(x, y)) {
+            return compare(y, z) ? b : (compare(x, z) ? c : a);
+        }
+        return compare(x, z) ? a : (compare(y, z) ? c : b);
+    };
+
+    const int mid = low + (high - low) / 2;
+    if (high - low + 1 < NINTHER_THRESHOLD) {
+        return median(low, mid, high);
+    }
+
+    const int step = (high - low + 1) / 8;
+    return median(median(low, low + step, low + 2 * step),
+                  median(mid - step, mid, mid + step),
+                  median(high - 2 * step, high - step, high));
+}
+
+template <typename Projection, typename Compare>
+std::pair<int, int> partition(std::vector<Player> &players, int low, int high, int pivot, Projection projection, Compare compare) {
+    const auto x = projection(players[pivot]);
+    int lower = low;
+    int upper = high;
+    int i = low;
+    while (i <= upper) {
+        const auto key = projection(players[i]);
+        if (compare(key, x)) {
+            std::swap(players[lower++], players[i++]);
+        } else if (compare(x, key)) {
+            std::swap(players[i], players[upper--]);
+        } else {
+            i++;
+        }
+    }
+    return {lower, upper};
+}
+
+template <typename Projection, typename Compare>
+void heapSelect(std::vector<Player> &players, int low, int high, int k, Projection projection, Compare compare) {
+    auto less = [&](const Player &lhs, const Player &rhs) { return compare(projection(lhs), projection(rhs)); };
+    const auto first = players.begin() + low;
+    auto last = players.begin() + high + 1;
+    std::make_heap(first, last, less); // max-heap
+    for (int i = high; i >= k; --i) {
+        std::pop_heap(first, last--, less);
+    }
+}
+
+template <typename Projection, typename Compare>
+void quickSort(std::vector<Player> &players, int low, int high, int depth, Projection projection, Compare compare) {
+    while (low < high) {
+        if (depth-- == 0) {
+            auto less = [&](const Player &lhs, const Player &rhs) { return compare(projection(lhs), projection(rhs)); };
+            std::make_heap(players.begin() + low, players.begin() + high + 1, less);
+            std::sort_heap(players.begin() + low, players.begin() + high + 1, less);
+            return;
+        }
+
+        const auto [lower, upper] = partition(players, low, high, choosePivot(players, low, high, projection, compare), projection, compare);
+        if (lower - low < high - upper) {
+            quickSort(players, low, lower - 1, depth, projection, compare);
+            low = upper + 1;
+        } else {
+            quickSort(players, upper + 1, high, depth, projection, compare);
+            high = lower - 1;
+        }
+    }
+}
+
+template <typename Projection, typename Compare>
+void quickSelect(std::vector<Player> &players, int low, int high, int k, Projection projection, Compare compare) {
+    for (int depth = depthLimit(low, high); low < high; --depth) {
+        if (depth == 0) {
+            heapSelect(players, low, high, k, projection, compare);
+            return;
+        }
+
+        const auto [lower, upper] = partition(players, low, high, choosePivot(players, low, high, projection, compare), projection, compare);
+        if (k < lower) {
+            high = lower - 1;
+        } else if (k > upper) {
+            low = upper + 1;
+        } else {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief quickSelectRankView(), ranking by compare(projection(lhs), projection(rhs)) rather than by level,
+ *        eg. quickSelectRankViewBy(players, ByLevelThenId{}).
+ *
+ * Both are template parameters, so the comparisons are inlined into the partitioning loops.
+ *
+ * @return A view of the top 10% of players, sorted (ascending) in place at the tail of `players`.
+ * @post The order of the parameter vector is modified.
+ */
+template <typename Projection = ByLevel, typename Compare = std::less<>>
+RankingView quickSelectRankViewBy(std::vector<Player> &players, Projection projection = {}, Compare compare = {}) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    int topTen = players.size() - (std::floor(0.1 * players.size()));
+    quickSelect(players, 0, players.size() - 1, topTen, projection, compare);
+    quickSort(players, topTen, players.size() - 1, depthLimit(topTen, players.size() - 1), projection, compare);
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    return {players.begin() + topTen, players.end(), time.count()};
+}
+
+/**
+ * @brief quickSelectRank(), ranking by compare(projection(lhs), projection(rhs)) rather than by level.
+ *
+ * @return A Ranking Result object as quickSelectRank()'s, whose top_ is sorted ascending under that order
+ * @post The order of the parameter vector is modified.
+ */
+template <typename Projection = ByLevel, typename Compare = std::less<>>
+RankingResult quickSelectRankBy(std::vector<Player> &players, Projection projection = {}, Compare compare = {}, Transfer transfer = Transfer::Copy) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const RankingView view = quickSelectRankViewBy(players, projection, compare);
+    RankingResult result(transferRange(view.begin(), view.end(), transfer));
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+/**
+ * @brief heapRankView(), ranking by compare(projection(lhs), projection(rhs)) rather than by level.
+ *
+ * @return A view of the top 10% of players, sorted (ascending) in place at the tail of `players`.
+ * @post The order of the parameter vector is modified.
+ */
+template <typename Projection = ByLevel, typename Compare = std::less<>>
+RankingView heapRankViewBy(std::vector<Player> &players, Projection projection = {}, Compare compare = {}) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    auto less = [&](const Player &lhs, const Player &rhs) { return compare(projection(lhs), projection(rhs)); };
+    const size_t topTen = std::floor(0.1 * players.size());
+    std::make_heap(players.begin(), players.end(), less); // max-heap
+    for (size_t i = 0; i < topTen; ++i) {
+        std::pop_heap(players.begin(), players.end() - i, less);
+    }
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    return {players.end() - topTen, players.end(), time.count()};
+}
+
+/**
+ * @brief heapRank(), ranking by compare(projection(lhs), projection(rhs)) rather than by level.
+ *
+ * @return A Ranking Result object as heapRank()'s, whose top_ is sorted ascending under that order
+ * @post The order of the parameter vector is modified.
+ */
+template <typename Projection = ByLevel, typename Compare = std::less<>>
+RankingResult heapRankBy(std::vector<Player> &players, Projection projection = {}, Compare compare = {}, Transfer transfer = Transfer::Copy) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const RankingView view = heapRankViewBy(players, projection, compare);
+    RankingResult result(transferRange(view.begin(), view.end(), transfer));
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+/**
+ * @brief quickSelect() for several indices at once: rearranges players[low..high] so that
+ * every index in [first, last) holds the Player it would if the range were sorted.
+ * Each partition splits the indices between its two sides, & only sides holding any are revisited,
+ * so all of them are placed in one sweep. Falls back to heapSelect() once `depth` partitions have been spent.
+ *
+ * @pre [first, last) is sorted ascending & within [low, high].
+ */
+void multiQuickSelect(std::vector<Player> &players, int low, int high, const int *first, const int *last, int depth);
+
+/**
+ * @brief Finds the cutoff level of several top fractions in a single partitioning sweep,
+ *        e.g. multiSelect(players, {0.01, 0.05, 0.1, 0.25}).
+ *
+ * @param players A reference to the vector of Player objects to be ranked
+ * @param fractions The top fractions, each within [0, 1] & in any order
+ * @param transfer Whether top_ is copied from `players` or moved out of it
+ * @return A MultiSelectResult whose
+ * - cutoffs_ -> Holds the cutoff level of each fraction, in the order given
+ * - top_     -> Contains the top floor(min(fractions) * N) players, sorted (ascending)
+ * - elapsed_ -> Contains the duration (ms) of the selection/sorting operation
+ *
+ * @post The order of the parameter vector is modified.
+ * @throws std::invalid_argument If a fraction is not within [0, 1].
+ */
+MultiSelectResult multiSelect(std::vector<Player> &players, const std::vector<double> &fractions, Transfer transfer = Transfer::Copy);
+}; // namespace Offline
+
+namespace Online {
+using PlayerIt = std::vector<Player>::iterator;
+using KeyIt = std::vector<RankKey>::iterator;
+
+/**
+ * @brief The number of Players rankIncoming() requests from its stream per nextChunk() call.
+ */
+constexpr size_t CHUNK_SIZE = 4096;
+
+/**
+ * @brief Reads a stream in chunks of up to CHUNK_SIZE, accumulating the time spent in
+ *        each nextChunk() (& the stream's stalls) into a RankingMetrics, so the Online rankings
+ *        can leave it out of elapsed_. Counts the Players & bytes fetched when METRICS_ENABLED.
+ */
+class ChunkFetcher {
+private:
+    PlayerStream &stream_;
+    RankingMetrics &metrics_;
+    double stallStart_;
+
+public:
+    ChunkFetcher(PlayerStream &stream, RankingMetrics &metrics) : stream_{stream}, metrics_{metrics}, stallStart_{stream.stallTime()} {}
+
+    /**
+     * @brief Returns the stream's next chunk of up to `max_count` Players, empty once it is exhausted.
+     */
+    PlayerChunk next(const size_t &max_count = CHUNK_SIZE) {
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        const PlayerChunk chunk = stream_.nextChunk(max_count);
+        const auto t2 = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> time = t2 - t1;
+        metrics_.fetch_ms_ += time.count();
+        metrics_.stall_ms_ = stream_.stallTime() - stallStart_;
+
+        if constexpr (METRICS_ENABLED) {
+            metrics_.players_fetched_ += chunk.size();
+            for (const Player &player : chunk) {
+                metrics_.bytes_fetched_ += sizeof(player.level_) + sizeof(player.id_) + player.name_.size();
+            }
+        }
+        return chunk;
+    }
+};
+
+/**
+ * @brief A helper method that replaces the minimum element
+ * in a min-heap with a target value & preserves the heap
+ * by percolating the new value down to its correct position.
+ *
+ * Performs in O(log N) time.
+ *
+ * @pre The range [first, last) is a min-heap.
+ *
+ * @param first An iterator to a vector of Player objects
+ *      denoting the beginning of a min-heap
+ *      NOTE: Unlike the textbook, this is *not* an empty slot
+ *      used to store temporary values. It is the root of the heap.
+ *
+ * @param last An iterator to a vector of Player objects
+ *      denoting one past the end of a min-heap
+ *      (i.e. it is not considering a valid index of the heap)
+ *
+ * @param target A reference to a Player object to be inserted into the heap
+ * @post
+ * - The vector slice denoted from [first,last) is a min-heap
+ *   into which `target` has been inserted.
+ * - The contents of `target` is not guaranteed to match its original state
+ *   (ie. you may move it).
+ */
+void replaceMin(PlayerIt first, PlayerIt last, Player &target);
+
+/**
+ * @brief As above, but copies `target` over the minimum, reusing the evicted Player's storage.
+ */
+void replaceMin(PlayerIt first, PlayerIt last, const Player &target);
+void replaceMin(KeyIt first, KeyIt last, RankKey &target);
+
+/**
+ * @brief The cache line size the d-ary heaps lay their keys out for, in bytes.
+ */
+constexpr size_t CACHE_LINE = 64;
+
+/**
+ * @brief An allocator whose allocations start on a CACHE_LINE boundary.
+ */
+template <typename T>
+struct CacheAlignedAllocator {
+    using value_type = T;
+
+    CacheAlignedAllocator() = default;
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U> &) {}
+
+    T *allocate(size_t count) { return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(CACHE_LINE))); }
+    void deallocate(T *memory, size_t) { ::operator delete(memory, std::align_val_t(CACHE_LINE)); }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheAlignedAllocator<U> &) const { return false; }
+};
+
+/**
+ * @brief replaceMin() for a D-ary min-heap, where the children of index i are D * i + 1 ... D * i + D.
+ *
+ * A D-ary heap is log2(D) times shallower, & a node's children are adjacent,
+ * so each level costs one scan of D neighbouring keys rather than a likely cache miss.
+ * Instead of swapping at every level, the smallest child is moved up into the hole
+ * left above it, & `target` is written once at the end.
+ *
+ * @tparam D The arity, fixed at compile time (eg. 4 or 8)
+ * @param less The order the heap is a min-heap under
+ * @pre The range [first, last) is a non-empty D-ary min-heap.
+ */
+template <unsigned D, typename It, typename Less = std::less<>>
+void replaceMin(It first, It last, typename std::iterator_traits<It>::value_type target, Less less = {}) {
+    const size_t size = last - first;
+    size_t hole = 0;
+    while (true) {
+        const size_t child = D * hole + 1;
+        if (child >= size) {
+            break;
+        }
+
+        size_t smallest = child;
+        const size_t end = std::min<size_t>(child + D, size);
+        for (size_t i = child + 1; i < end; ++i) {
+            if (less(first[i], first[smallest])) {
+                smallest = i;
+            }
+        }
+        if (!less(first[smallest], target)) {
+            break;
+        }
+        first[hole] = std::move(first[smallest]);
+        hole = smallest;
+    }
+    first[hole] = std::move(target);
+}
+
+/**
+ * @brief std::push_heap() for a D-ary min-heap: percolates *(last - 1) up into [first, last - 1).
+ *
+ * @tparam D The arity, fixed at compile time (eg. 4 or 8)
+ * @param less The order the heap is a min-heap under
+ * @pre The range [first, last - 1) is a D-ary min-heap.
+ */
+template <unsigned D, typename It, typename Less = std::less<>>
+void pushHeap(It first, It last, Less less = {}) {
+    size_t hole = (last - first) - 1;
+    typename std::iterator_traits<It>::value_type target = std::move(first[hole]);
+    while (hole > 0) {
+        const size_t parent = (hole - 1) / D;
+        if (!less(target, first[parent])) {
+            break;
+        }
+        first[hole] = std::move(first[parent]);
+        hole = parent;
+    }
+    first[hole] = std::move(target);
+}
+
+/**
+ * @brief Finds the first Player in [first, last) whose level is above `threshold`.
+ *
+ * Once a leaderboard is full, nearly every incoming Player is at or below its minimum,
+ * so the online loops use this to skip straight to the next Player that can be admitted.
+ * Dispatches at runtime to an AVX2 kernel, which gathers & compares the levels of 8 Players
+ * at a time, when the CPU supports it, & to findAboveScalar() otherwise.
+ *
+ * @return A pointer to that Player, or `last` if there is none.
+ */
+const Player *findAbove(const Player *first, const Player *last, const size_t &threshold);
+const Player *findAboveScalar(const Player *first, const Player *last, const size_t &threshold);
+
+/**
+ * @brief findAbove() over a level column: the index of the first level from `from` on above `threshold`,
+ *        or levels.size_ if there is none.
+ */
+size_t findAbove(const LevelColumn &levels, size_t from, const size_t &threshold);
+size_t findAboveScalar(const LevelColumn &levels, size_t from, const size_t &threshold);
+
+/**
+ * @brief An immutable, sorted copy of a Leaderboard published for concurrent readers.
+ */
+struct LeaderboardSnapshot {
+    /**
+     * @brief The leaderboard's Players at the time of publication, sorted in ascending order.
+     */
+    std::vector<Player> top_;
+
+    /**
+     * @brief The number of Players the leaderboard had ingested when this was published.
+     */
+    size_t count_;
+
+    /**
+     * @brief Increases by one with every publication, starting from 1.
+     */
+    size_t version_;
+};
+
+/**
+ * @brief A live top-<reporting_interval> leaderboard that can be queried while Players are still arriving.
+ *
+ * Owns the min-heap that rankIncoming() maintains with `replaceMin()`, along with the
+ * cutoffs recorded every <reporting_interval> Players. rankIncoming() is a Leaderboard
+ * fed until its stream runs dry.
+ *
+ * @example
+ * Online::Leaderboard leaderboard(50);
+ * leaderboard.ingest(stream.nextChunk(Online::CHUNK_SIZE));
+ * leaderboard.cutoff()   -> The minimum level currently on the leaderboard
+ * leaderboard.snapshot() -> The current top 50, sorted ascending
+ *
+ * A Leaderboard has a single writer: ingest(), snapshot() & finish() must not be called concurrently.
+ * Other threads read through publishedCutoff() & published() instead, which never block ingestion:
+ * at reporting boundaries the writer stores the cutoff in an atomic, & every <publish_every> intervals
+ * swaps in a freshly-built LeaderboardSnapshot. Readers holding an older snapshot keep it alive
+ * until they drop it.
+ *
+ * Snapshots are swapped in RCU-style through PUBLISH_SLOTS slots: the writer fills a slot no reader is
+ * in, then points an atomic index at it, & a reader announces itself in a slot's counter before copying
+ * its shared_ptr. Neither side takes a lock, & the writer never waits: if every other slot is being read,
+ * the snapshot is held back & swapped in at a later reporting boundary.
+ */
+class Leaderboard {
+private:
+    size_t reporting_interval_;
+    size_t count_;
+
+    /**
+     * @brief A min-heap of the highest leveled Players ingested so far, at most `reporting_interval_` long.
+     */
+    std::vector<Player> heap_;
+    CutoffSeries cutoffs_;
+
+    /**
+     * @brief The sorted copy of `heap_` handed out by snapshot(), brought up to date only once `stale_`.
+     */
+    mutable std::vector<Player> snapshot_;
+    mutable bool stale_;
+
+    /**
+     * @brief Copies of the Players admitted since snapshot_ was last brought up to date, while `logging_`.
+     * Logging stops once more than half the leaderboard has turned over, when re-sorting is as cheap.
+     */
+    mutable std::vector<Player> admitted_;
+    mutable bool logging_;
+
+    /**
+     * @brief Marks the snapshot stale after `player` was admitted, logging it if need be.
+     */
+    void noteAdmitted(const Player &player) {
+        stale_ = true;
+        if (logging_) {
+            admitted_.push_back(player);
+            logging_ = 2 * admitted_.size() <= reporting_interval_;
+        }
+    }
+
+    /**
+     * @brief The number of reporting intervals between publications, 0 to only publish on request.
+     */
+    size_t publish_every_;
+    size_t version_;
+    std::atomic<size_t> published_cutoff_;
+
+    /**
+     * @brief The number of slots published snapshots rotate through: the current one,
+     *        & spares for the writer while readers linger in the previous ones.
+     */
+    static constexpr size_t PUBLISH_SLOTS = 3;
+
+    /**
+     * @brief A published snapshot & the number of readers copying it right now,
+     *        on its own cache line so readers of one slot do not slow the writer's checks of another.
+     */
+    struct alignas(CACHE_LINE) PublishSlot {
+        std::shared_ptr<const LeaderboardSnapshot> snapshot_;
+        mutable std::atomic<size_t> readers_{0};
+    };
+    PublishSlot slots_[PUBLISH_SLOTS];
+
+    /**
+     * @brief The slot holding the latest published snapshot, or PUBLISH_SLOTS before the first.
+     */
+    std::atomic<size_t> current_;
+
+    /**
+     * @brief A snapshot published while every other slot was being read, swapped in by the next attempt.
+     */
+    std::shared_ptr<const LeaderboardSnapshot> pending_;
+
+    /**
+     * @brief Moves `pending_` into a slot no reader is in & makes it current, if there is one.
+     */
+    void swapInPending();
+
+    /**
+     * @brief The heap's time & work so far, counted only when METRICS_ENABLED.
+     */
+    RankingMetrics metrics_;
+
+public:
+    /**
+     * @brief Constructs an empty Leaderboard.
+     *
+     * @pre reporting_interval > 0
+     * @param reporting_interval The number of Players kept, & the frequency at which to record cutoff levels
+     * @param publish_every The number of reporting intervals between automatic publish() calls,
+     *      or 0 (the default) to only publish when asked. Each publication copies & sorts the leaderboard.
+     */
+    explicit Leaderboard(const size_t &reporting_interval, const size_t &publish_every = 0);
+
+    Leaderboard(const Leaderboard &) = delete;
+    Leaderboard &operator=(const Leaderboard &) = delete;
+
+    /**
+     * @brief Offers Player(s) to the leaderboard, in order.
+     *
+     * Each Player is admitted if the leaderboard is not yet full, or if it beats the
+     * current minimum (which it then replaces). The cutoff is recorded after every
+     * <reporting_interval> Players.
+     *
+     * @param player The Player to offer. It is copied only if admitted.
+     * @param players The Players to offer, filtered against the current minimum
+     *      before any of them touch the heap.
+     */
+    void ingest(const Player &player);
+    void ingest(const PlayerChunk &players);
+
+    /**
+     * @brief Returns the minimum level required to be on the leaderboard right now, in O(1).
+     *
+     * @return The lowest level on the leaderboard, or 0 if it is empty.
+     */
+    size_t cutoff() const;
+
+    /**
+     * @brief Returns the current top Players sorted in ascending order, without disturbing the heap.
+     *
+     * The sorted copy is cached, so repeated reads between changes cost O(1). The first read after
+     * k Players were admitted merges them into it in O(r + k log k), rather than sorting all r again:
+     * the minimum admissions replace never falls, so every Player above the current cutoff in the
+     * last copy, or admitted since, is still on the leaderboard. Only once k > r / 2 is it re-sorted.
+     *
+     * @return A reference valid until the next call to ingest() or finish().
+     */
+    const std::vector<Player> &snapshot() const;
+
+    /**
+     * @brief Returns the cutoffs recorded at every reporting boundary so far (see RankingResult::cutoffs_).
+     * The final, partial-interval cutoff is only added by finish().
+     */
+    const CutoffSeries &cutoffs() const;
+
+    /**
+     * @brief Returns the number of Players ingested so far.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Returns the number of Players currently on the leaderboard, at most <reporting_interval>.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Hands over the leaderboard's contents as a RankingResult.
+     *
+     * @return A RankingResult whose top_ & cutoffs_ are as described for rankIncoming(),
+     *  & whose metrics_ hold the heap's metrics (see metrics()). elapsed_ is left 0 for the caller to fill in.
+     * @post The leaderboard is empty, as if newly constructed.
+     */
+    RankingResult finish();
+
+    /**
+     * @brief Returns the time & work of the heap operations so far, when METRICS_ENABLED:
+     *        build_ms_, replace_ms_, comparisons_, swaps_ & replacements_, with sort_ms_ added by finish().
+     */
+    const RankingMetrics &metrics() const;
+
+    /**
+     * @brief Publishes the current leaderboard for concurrent readers. Called by the writer.
+     *
+     * @post publishedCutoff() returns the current cutoff(), & published() returns a
+     *  LeaderboardSnapshot of the current top, unless readers were still copying each of
+     *  the other slots: that snapshot is then published at a later reporting boundary, or publish().
+     */
+    void publish();
+
+    /**
+     * @brief Returns the cutoff as of the last reporting boundary or publish(). Safe from any thread.
+     */
+    size_t publishedCutoff() const;
+
+    /**
+     * @brief Returns the latest published snapshot, or nullptr if nothing was published yet. Safe from any thread.
+     *
+     * Lock-free: it only retries if the writer swapped in a newer snapshot while it was looking.
+     */
+    std::shared_ptr<const LeaderboardSnapshot> published() const;
+};
+
+/**
+ * @brief A binary heap of slot numbers that tracks where each slot sits,
+ *        so any slot, not just the root, can be removed or re-sifted in O(log N).
+ *
+ * @tparam Before A functor where Before(a, b) is true when slot `a` belongs nearer the root than slot `b`.
+ *      It is usually a view of the owner's per-slot storage, where the ordering keys live.
+ */
+template <typename Before>
+class IndexedHeap {
+public:
+    static constexpr size_t NPOS = std::numeric_limits<size_t>::max();
+
+    explicit IndexedHeap(Before before = Before()) : before_{before} {}
+
+    bool empty() const { return heap_.empty(); }
+    size_t size() const { return heap_.size(); }
+
+    /**
+     * @brief Returns the slot at the root.
+     * @pre The heap is not empty.
+     */
+    size_t top() const { return heap_[0]; }
+
+    bool contains(const size_t &slot) const { return slot < positions_.size() && positions_[slot] != NPOS; }
+
+    /**
+     * @brief Returns the slots in heap order.
+     */
+    const std::vector<size_t> &slots() const { return heap_; }
+
+    /**
+     * @pre `slot` is not in the heap.
+     */
+    void push(const size_t &slot) {
+        if (slot >= positions_.size()) {
+            positions_.resize(slot + 1, NPOS);
+        }
+        heap_.push_back(slot);
+        positions_[slot] = heap_.size() - 1;
+        siftUp(heap_.size() - 1);
+    }
+
+    /**
+     * @brief Removes & returns the slot at the root.
+     * @pre The heap is not empty.
+     */
+    size_t pop() {
+        const size_t slot = heap_[0];
+        erase(slot);
+        return slot;
+    }
+
+    /**
+     * @pre `slot` is in the heap.
+     */
+    void erase(const size_t &slot) {
+        const size_t index = positions_[slot];
+        positions_[slot] = NPOS;
+        const size_t last = heap_.back();
+        heap_.pop_back();
+        if (index < heap_.size()) {
+            heap_[index] = last;
+            positions_[last] = index;
+            siftDown(siftUp(index));
+        }
+    }
+
+    /**
+     * @brief Restores the heap after the key of `slot` changed.
+     * @pre `slot` is in the heap.
+     */
+    void update(const size_t &slot) { siftDown(siftUp(positions_[slot])); }
+
+    void clear() {
+        for (const size_t &slot : heap_) {
+            positions_[slot] = NPOS;
+        }
+        heap_.clear();
+    }
+
+private:
+    Before before_;
+    std::vector<size_t> heap_;
+
+    /**
+     * @brief positions_[slot] is the index of `slot` in `heap_`, or NPOS if it is not in the heap.
+     */
+    std::vector<size_t> positions_;
+
+    void swapAt(const size_t &a, const size_t &b) {
+        std::swap(heap_[a], heap_[b]);
+        positions_[heap_[a]] = a;
+        positions_[heap_[b]] = b;
+    }
+
+    size_t siftUp(size_t index) {
+        while (index > 0) {
+            const size_t parent = (index - 1) / 2;
+            if (!before_(heap_[index], heap_[parent])) {
+                break;
+            }
+            swapAt(index, parent);
+            index = parent;
+        }
+        return index;
+    }
+
+    void siftDown(size_t index) {
+        while (true) {
+            const size_t child = index * 2 + 1;
+            size_t best = index;
+            if (child < heap_.size() && before_(heap_[child], heap_[best])) {
+                best = child; // Left Child
+            }
+            if (child + 1 < heap_.size() && before_(heap_[child + 1], heap_[best])) {
+                best = child + 1; // Right Child
+            }
+            if (best == index) {
+                return;
+            }
+            swapAt(index, best);
+            index = best;
+        }
+    }
+};
+
+/**
+ * @brief IndexedHeap orderings over slots of a vector of Players: a min-heap & a max-heap by level.
+ */
+struct LowerLevelFirst {
+    const std::vector<Player> *players_;
+    bool operator()(const size_t &a, const size_t &b) const { return (*players_)[a].level_ < (*players_)[b].level_; }
+};
+struct HigherLevelFirst {
+    const std::vector<Player> *players_;
+    bool operator()(const size_t &a, const size_t &b) const { return (*players_)[a].level_ > (*players_)[b].level_; }
+};
+
+/**
+ * @brief A leaderboard of the <r> highest leveled Players among only the most recent ones:
+ *        the last `max_players` ingested, those ingested within the last `max_age`, or both.
+ *
+ * The Players that may still make the leaderboard (the candidates) are kept in one of two
+ * IndexedHeaps over shared slots: a min-heap of the current top r, & a max-heap of the rest.
+ * Ingesting a Player, or expiring the oldest candidate, moves at most one Player between them.
+ *
+ * A Player with r newer Players at or above its level can never return to the top r before it
+ * expires, since those expire after it. Once the rest has grown to four times its size after the previous
+ * prune (plus 4r), a newest-first sweep drops every such Player, in O(C log r) for C candidates.
+ * That is O(log r) amortized per Player, & each event costs O(log C) in the heaps.
+ *
+ * @note C is not bounded by r: on randomly ordered levels it is O(r log(W / r)) in expectation for
+ *       a window of W Players, but if levels only fall over time no Player is ever dominated, so C = W.
+ *       With a max_age, the window also keeps one arrival time per Player, to count them (windowSize()).
+ */
+class WindowedLeaderboard {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructs an empty WindowedLeaderboard.
+     *
+     * @pre r > 0, & at least one of max_players & max_age is set.
+     * @param r The number of Players on the leaderboard
+     * @param max_players The number of most recent Players in the window, or 0 for no limit
+     * @param max_age How long a Player stays in the window after being ingested, or zero for no limit
+     * @throws std::invalid_argument If the preconditions are not met.
+     */
+    WindowedLeaderboard(const size_t &r, const size_t &max_players, const Clock::duration &max_age = Clock::duration::zero());
+
+    WindowedLeaderboard(const WindowedLeaderboard &) = delete;
+    WindowedLeaderboard &operator=(const WindowedLeaderboard &) = delete;
+
+    /**
+     * @brief Adds `player` to the window as of `now`, first expiring every Player that has left it.
+     * @pre `now` is no earlier than the previous call's.
+     */
+    void ingest(const Player &player, const Clock::time_point &now = Clock::now());
+
+    /**
+     * @brief Expires every Player ingested more than max_age before `now`. Does nothing without a max_age.
+     */
+    void expire(const Clock::time_point &now = Clock::now());
+
+    /**
+     * @brief Returns the minimum level required to be on the leaderboard right now, in O(1).
+     *
+     * @return The lowest level on the leaderboard, or 0 if it is empty.
+     */
+    size_t cutoff() const;
+
+    /**
+     * @brief Returns the current top Players sorted in ascending order, in O(r log r).
+     */
+    std::vector<Player> snapshot() const;
+
+    /**
+     * @brief Returns the number of Players on the leaderboard, at most r.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the number of Players in the window, on the leaderboard or not.
+     */
+    size_t windowSize() const;
+
+    /**
+     * @brief Returns the number of candidates kept, on the leaderboard or not: at most windowSize().
+     */
+    size_t candidateCount() const;
+
+private:
+    size_t r_;
+    size_t max_players_;
+    Clock::duration max_age_;
+
+    /**
+     * @brief The window holds the Players numbered [window_start_, ingested_), in ingestion order.
+     */
+    size_t ingested_;
+    size_t window_start_;
+
+    /**
+     * @brief The arrival time of every Player in the window, oldest first. Only kept with a max_age.
+     */
+    std::deque<Clock::time_point> arrivals_;
+
+    /**
+     * @brief Per-slot storage for the candidates. Slots are reused through `free_` once their Player
+     * expires or is pruned. sequences_[slot] is the slot's Player's number in ingestion order.
+     */
+    std::vector<Player> players_;
+    std::vector<size_t> sequences_;
+    std::vector<size_t> free_;
+
+    /**
+     * @brief The candidates' slots, oldest first, stored in [head_, head_ + filled_) modulo its size.
+     * Its size is a power of two, & grows by doubling, so a steady window cycles through it without allocating.
+     */
+    std::vector<size_t> candidates_;
+    size_t head_;
+    size_t filled_;
+
+    size_t &candidate(const size_t &i) { return candidates_[(head_ + i) & (candidates_.size() - 1)]; }
+
+    /**
+     * @brief The size of rest_ at which the next prune() runs.
+     */
+    size_t prune_at_;
+
+    /**
+     * @brief prune()'s min-heap of levels, kept to reuse its buffer.
+     */
+    std::vector<size_t> newer_;
+
+    IndexedHeap<LowerLevelFirst> top_;
+    IndexedHeap<HigherLevelFirst> rest_;
+
+    /**
+     * @brief Moves window_start_ forward to `start`, expiring the candidates that leave the window.
+     */
+    void advanceTo(const size_t &start);
+
+    /**
+     * @brief Removes the oldest candidate, promoting the best of the rest if it was on the leaderboard.
+     */
+    void expireOldest();
+
+    /**
+     * @brief Drops every candidate in rest_ with r newer candidates at or above its level.
+     */
+    void prune();
+};
+
+/**
+ * @brief A leaderboard of the <r> highest leveled players, where each player (identified by id_)
+ *        appears once & can level up or down, for leaderboards fed by a change stream.
+ *
+ * Like WindowedLeaderboard, it keeps a min-heap of the top r & a max-heap of everyone else,
+ * both IndexedHeaps over shared slots, with an id_ -> slot index. A level change re-sifts
+ * the player in place, & then swaps the top's minimum with the best player below the cutoff
+ * if they crossed, so each change costs O(log P) for P players instead of a duplicate insert.
+ * Every known player is kept, since anyone below the cutoff may be needed once a top player drops.
+ *
+ * @note rest_ is not a bounded side structure of near-cutoff candidates: it holds every known player
+ *       off the leaderboard, so memory grows with P & updates cost O(log P), not O(log r).
+ *       Bounding it would lose the exact replacement when a top player falls or is erased.
+ */
+class UpdatableLeaderboard {
+public:
+    /**
+     * @pre r > 0
+     * @throws std::invalid_argument If r is 0.
+     */
+    explicit UpdatableLeaderboard(const size_t &r);
+
+    UpdatableLeaderboard(const UpdatableLeaderboard &) = delete;
+    UpdatableLeaderboard &operator=(const UpdatableLeaderboard &) = delete;
+
+    /**
+     * @brief Adds `player`, or if a player with its id_ is already known, replaces it (name & level).
+     */
+    void upsert(const Player &player);
+
+    /**
+     * @brief Changes the level of the player with the given id.
+     * @throws std::out_of_range If no player has that id.
+     */
+    void updateLevel(const size_t &id, const size_t &level);
+
+    /**
+     * @brief Forgets the player with the given id, promoting the best player below the cutoff if it was on the leaderboard.
+     * @return Whether a player had that id.
+     */
+    bool erase(const size_t &id);
+
+    bool contains(const size_t &id) const;
+
+    /**
+     * @brief Returns the player with the given id.
+     * @throws std::out_of_range If no player has that id.
+     */
+    const Player &at(const size_t &id) const;
+
+    /**
+     * @brief Returns the minimum level required to be on the leaderboard right now, in O(1).
+     *
+     * @return The lowest level on the leaderboard, or 0 if it is empty.
+     */
+    size_t cutoff() const;
+
+    /**
+     * @brief Returns the current top players sorted in ascending order, in O(r log r).
+     */
+    std::vector<Player> snapshot() const;
+
+    /**
+     * @brief Returns the number of players on the leaderboard, at most r.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the number of known players, on the leaderboard or not.
+     */
+    size_t playerCount() const;
+
+private:
+    size_t r_;
+    std::vector<Player> players_;
+    std::vector<size_t> free_;
+    std::unordered_map<size_t, size_t> slots_;
+    IndexedHeap<LowerLevelFirst> top_;
+
+    /**
+     * @brief Every known player off the leaderboard, unbounded (see the class note).
+     */
+    IndexedHeap<HigherLevelFirst> rest_;
+
+    /**
+     * @brief Re-sifts `slot` after its level changed, & restores the split between the two heaps.
+     */
+    void reposition(const size_t &slot);
+};
+
+/**
+ * @brief rankIncoming() for a change stream: each Player read updates the level of the player
+ *        with its id_ (or adds it), rather than being ranked as a new entry.
+ *
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the <reporting_interval> highest leveled distinct players at the end of
+ *                  the stream, with their latest levels, in sorted order (ascending)
+ * - cutoffs_    -> Holds the cutoff after every <reporting_interval> updates, & after the last one
+ * - elapsed_    -> Contains the duration (ms) of the ranking
+ */
+RankingResult rankUpdates(PlayerStream &stream, const size_t &reporting_interval);
+
+/**
+ * @brief Exhausts a stream of Players (ie. until there are none left) such that we:
+ * 1) Maintain a running collection of the <reporting_interval> highest leveled players
+ * 2) Record the Player level after reading every <reporting_interval> players
+ *    representing the minimum level required to be in the leaderboard at that point.
  *
  * @note You should use NOT use a priority-queue.
  *       Instead, use a vector, the STL heap operations, & `replaceMin()`
  *
+ * @note Players are pulled from the stream in chunks of up to CHUNK_SIZE & fed to a Leaderboard.
+ *       Once the leaderboard is full, each chunk is filtered against the
+ *       current minimum level so only Players that beat it reach the heap.
+ *
  * @param stream A stream providing Player objects
  * @param reporting_interval The frequency at which to record cutoff levels
+ * @param backend Whether the heap holds the Players themselves, or RankKeys for them
+ *      (see rankIncomingKeys())
+ * @param arity The heap's arity for Backend::Keys: 2, 4 or 8 (see rankIncomingKeys()).
+ *      Backend::Objects always uses a binary heap.
  * @return A RankingResult in which:
  * - top_       -> Contains the top <reporting_interval> Players read in the stream in
  *                 sorted (least to greatest) order
@@ -155,5 +1846,379 @@ void replaceMin(PlayerIt first, PlayerIt last, Player &target);
  * cutoffs_ = { 50: 239, 100: 992, 132: 994 } (see RankingResult explanation)
  * elapsed_ = 0.003 (Your runtime will vary based on hardware)
  */
-RankingResult rankIncoming(PlayerStream &stream, const size_t &reporting_interval);
+RankingResult rankIncoming(PlayerStream &stream, const size_t &reporting_interval, Backend backend = Backend::Objects, unsigned arity = 2);
+
+/**
+ * @brief rankIncoming(), keeping the top Players under compare(projection(lhs), projection(rhs))
+ *        rather than by level, eg. rankIncomingBy(stream, r, ByLevelThenId{}).
+ *
+ * The order is fixed at compile time: ByLevel & std::less<> are rankIncoming() itself,
+ * & any other order keeps a binary min-heap under it, with the comparisons inlined.
+ *
+ * @return A RankingResult as rankIncoming()'s, whose top_ is sorted ascending under that order
+ *  & whose cutoffs_ record the level of the lowest-ranked Player on the leaderboard.
+ * @post All elements of the stream are read until there are none remaining.
+ */
+template <typename Projection = ByLevel, typename Compare = std::less<>>
+RankingResult rankIncomingBy(PlayerStream &stream, const size_t &reporting_interval, Projection projection = {}, Compare compare = {}) {
+    if constexpr (std::is_same_v<Projection, ByLevel> && std::is_same_v<Compare, std::less<>>) {
+        return rankIncoming(stream, reporting_interval);
+    } else {
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        RankingResult result;
+        result.cutoffs_ = CutoffSeries(reporting_interval);
+        size_t count = 0;
+
+        auto less = [&](const Player &lhs, const Player &rhs) { return compare(projection(lhs), projection(rhs)); };
+        std::vector<Player> &heap = result.top_; // A min-heap under `less`
+        heap.reserve(reporting_interval);
+        ChunkFetcher fetcher(stream, result.metrics_);
+        for (PlayerChunk chunk = fetcher.next(); !chunk.empty(); chunk = fetcher.next()) {
+            for (const Player &player : chunk) {
+                if (heap.size() < reporting_interval) {
+                    heap.push_back(player);
+                    pushHeap<2>(heap.begin(), heap.end(), less);
+                } else if (less(heap.front(), player)) {
+                    replaceMin<2>(heap.begin(), heap.end(), player, less);
+                }
+                if (++count % reporting_interval == 0) {
+                    result.cutoffs_.record(count, heap.front().level_);
+                }
+            }
+        }
+        if (count % reporting_interval != 0 && heap.empty() == false) {
+            result.cutoffs_.record(count, heap.front().level_);
+        }
+        std::sort(heap.begin(), heap.end(), less);
+
+        const auto t2 = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> time = t2 - t1;
+        result.elapsed_ = time.count() - result.metrics_.fetch_ms_;
+        return result;
+    }
+}
+
+/**
+ * @brief The number of Players parallelRankIncoming() reads from its stream per round,
+ *  rounded up to a whole number of reporting intervals.
+ */
+constexpr size_t ROUND_SIZE = 1 << 16;
+
+/**
+ * @brief A multi-threaded version of rankIncoming() with identical top_ & cutoffs_ levels.
+ *
+ * The stream is read in rounds of whole reporting intervals. Within a round, each interval
+ * is split into one contiguous slice per thread, & every worker keeps a local top-<reporting_interval>
+ * heap of its slice, skipping Players no higher than the leaderboard's minimum at the start of the round.
+ * At each interval boundary, the workers' heaps are merged into the leaderboard in order
+ * & the new minimum is recorded in cutoffs_.
+ *
+ * This is exact: a Player on the leaderboard after an interval has fewer than <reporting_interval>
+ * higher Players in that interval, so it is in its slice's local top.
+ *
+ * @param stream A stream providing Player objects
+ * @param reporting_interval The frequency at which to record cutoff levels
+ * @param threads The number of worker threads; 0 is treated as 1
+ * @return A RankingResult as returned by rankIncoming()
+ *
+ * @post All elements of the stream are read until there are none remaining.
+ */
+RankingResult parallelRankIncoming(PlayerStream &stream, const size_t &reporting_interval, unsigned threads);
+
+/**
+ * @brief The Backend::Keys version of rankIncoming().
+ *
+ * The leaderboard's Players sit in a fixed pool that is never reordered;
+ * the min-heap holds a RankKey per pool slot. Admitting a Player overwrites
+ * the evicted Player's slot in place & percolates only its 16-byte key.
+ *
+ * The keys form a D-ary heap (see replaceMin<D>()), in a cache-line-aligned array whose
+ * front is padded so that every node's children start on a cache line:
+ * for D = 4, each node's children are exactly one line.
+ *
+ * @param arity The heap's arity: 2, 4 or 8
+ * @throws std::invalid_argument For any other arity.
+ */
+RankingResult rankIncomingKeys(PlayerStream &stream, const size_t &reporting_interval, unsigned arity = 2);
+
+/**
+ * @brief rankIncoming() under the total order of StableKeys, breaking level ties by `tie_break`,
+ *        where a Player's position is its 0-based arrival index.
+ *
+ * Which of several Players tied at the cutoff is evicted is then fixed, so the
+ * leaderboard is reproducible Player-for-Player. By TieBreak::Position, a Player tied with
+ * the leaderboard's minimum is never admitted, as in rankIncoming(); by TieBreak::Id,
+ * it is admitted if its id is lower.
+ *
+ * @return A RankingResult as rankIncoming()'s, with ties in top_ ordered as in Offline::stableRank()
+ * @throws std::out_of_range If a level, or the position or id ties are broken by, does not fit in 32 bits.
+ * @post All elements of the stream are read until there are none remaining.
+ */
+RankingResult rankIncomingStable(PlayerStream &stream, const size_t &reporting_interval, TieBreak tie_break = TieBreak::Position);
+
+/**
+ * @brief An open-addressing hash map from partition keys to dense slots 0, 1, 2, ...,
+ *        probed linearly over a flat, power-of-two array of (key, slot) entries.
+ *
+ * A lookup hashes its key once & then scans adjacent entries, so it is usually a single
+ * cache miss, where a std::unordered_map would chase a pointer into its node list.
+ * The table doubles once half full, & never erases.
+ */
+class FlatPartitionMap {
+public:
+    /**
+     * @brief The slot find() returns for a key that is not in the map.
+     */
+    static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+    FlatPartitionMap();
+
+    /**
+     * @brief Returns the slot of `key`, or EMPTY if it has not been inserted.
+     */
+    uint32_t find(const uint64_t &key) const {
+        for (size_t i = hash(key) & mask_;; i = (i + 1) & mask_) {
+            const Entry &entry = entries_[i];
+            if (entry.slot_ == EMPTY || entry.key_ == key) {
+                return entry.slot_;
+            }
+        }
+    }
+
+    /**
+     * @brief Maps `key` to `slot`.
+     * @pre `key` is not in the map, & slot != EMPTY.
+     */
+    void insert(const uint64_t &key, const uint32_t &slot);
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        uint64_t key_;
+        uint32_t slot_;
+    };
+
+    std::vector<Entry> entries_;
+    size_t mask_;
+    size_t size_;
+
+    /**
+     * @brief The splitmix64 finalizer, so that consecutive keys (eg. region ids) spread over the table.
+     */
+    static uint64_t hash(uint64_t key) {
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+        return key ^ (key >> 31);
+    }
+};
+
+/**
+ * @brief The rankings of a PartitionedLeaderboard, one RankingResult per partition.
+ */
+struct PartitionedRankingResult {
+    /**
+     * @brief Each partition's key & its RankingResult, whose top_ & cutoffs_ are those of rankIncoming()
+     *        over just that partition's Players, in increasing key order. Their elapsed_ are left 0.
+     */
+    std::vector<std::pair<uint64_t, RankingResult>> partitions_;
+
+    /**
+     * @brief The duration (ms) of ranking every partition, excluding fetching Players from the stream.
+     */
+    double elapsed_ = 0;
+
+    /**
+     * @brief The stream's fetch_ms_, stall_ms_, players_fetched_ & bytes_fetched_, shared by all partitions.
+     */
+    RankingMetrics metrics_;
+
+    /**
+     * @brief Returns the RankingResult of `partition`, in O(log partitions).
+     * @throws std::out_of_range If no Player was routed to that partition.
+     */
+    const RankingResult &at(const uint64_t &partition) const;
+};
+
+/**
+ * @brief Many Leaderboards over one stream, eg. one per region & game mode: each Player is routed
+ *        to the top-<reporting_interval> min-heap of its partition, so the stream is read once
+ *        rather than once per partition.
+ *
+ * Partitions are found through a FlatPartitionMap & numbered densely as they are first seen.
+ * Their heaps are RankKey heaps (see rankIncomingKeys()) carved out of one pooled array:
+ * partition s owns keys [s * r, (s + 1) * r), & the same range of one pooled vector of Players,
+ * which is never reordered. The per-partition bookkeeping sits in its own flat array,
+ * apart from the cutoffs it reports.
+ *
+ * Once a partition's heap is full, a Player at or below its cached cutoff takes a fast path that
+ * reads only its map entry & that bookkeeping, & never touches the heap or the Player pool.
+ *
+ * @note A partition reserves room for <reporting_interval> Players when it is first seen,
+ *       so memory grows with partitions * reporting_interval.
+ *
+ * @example
+ * Online::PartitionedLeaderboard leaderboards(50);
+ * leaderboards.ingest(chunk, [](const Player &player) { return player.id_ % 16; });
+ * leaderboards.cutoff(3) -> The minimum level currently on partition 3's leaderboard
+ */
+class PartitionedLeaderboard {
+public:
+    /**
+     * @pre reporting_interval > 0
+     * @param reporting_interval The number of Players each partition keeps, & the number of
+     *      its Players between its recorded cutoffs
+     * @throws std::invalid_argument If reporting_interval is 0.
+     */
+    explicit PartitionedLeaderboard(const size_t &reporting_interval);
+
+    PartitionedLeaderboard(const PartitionedLeaderboard &) = delete;
+    PartitionedLeaderboard &operator=(const PartitionedLeaderboard &) = delete;
+
+    /**
+     * @brief Offers `player` to the leaderboard of `partition`, creating it if it is new.
+     *
+     * The Player is admitted as by Leaderboard::ingest(), & the partition's cutoff is recorded
+     * after every <reporting_interval> of its Players.
+     *
+     * @throws std::length_error If this would make more than 2^32 - 1 partitions.
+     */
+    void ingest(const Player &player, const uint64_t &partition) {
+        uint32_t slot = map_.find(partition);
+        if (slot == FlatPartitionMap::EMPTY) {
+            slot = addPartition(partition);
+        }
+        Partition &target = partitions_[slot];
+        // The fast path: a full heap only admits Players above its cutoff
+        if (target.size_ < reporting_interval_ || player.level_ > target.cutoff_) {
+            admit(target, player);
+        }
+        if (--target.until_report_ == 0) {
+            report(slot);
+        }
+    }
+
+    /**
+     * @brief Offers each of `players` to the leaderboard of partitionOf(player), in order.
+     *
+     * @param partitionOf A callable mapping a Player to its partition key (converted to uint64_t)
+     */
+    template <typename PartitionOf>
+    void ingest(const PlayerChunk &players, PartitionOf partitionOf) {
+        for (const Player &player : players) {
+            ingest(player, static_cast<uint64_t>(partitionOf(player)));
+        }
+    }
+
+    /**
+     * @brief Returns the minimum level required to be on the leaderboard of `partition` right now, in O(1).
+     *
+     * @return The lowest level on that leaderboard, or 0 if it is empty or unknown.
+     */
+    size_t cutoff(const uint64_t &partition) const;
+
+    /**
+     * @brief Returns the number of partitions seen so far.
+     */
+    size_t partitionCount() const;
+
+    /**
+     * @brief Returns the number of Players ingested so far, over all partitions.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Hands over every partition's leaderboard, recording each one's final, partial-interval cutoff.
+     *
+     * @return A PartitionedRankingResult whose elapsed_ & metrics_ are left for the caller to fill in.
+     * @post The leaderboard has no partitions, as if newly constructed.
+     */
+    PartitionedRankingResult finish();
+
+private:
+    /**
+     * @brief The bookkeeping ingest() reads for every Player routed to a partition.
+     */
+    struct Partition {
+        /**
+         * @brief The offset of the partition's range in keys_ & pool_, slot * reporting_interval_.
+         */
+        size_t base_;
+        size_t size_;
+
+        /**
+         * @brief The level of the heap's root, valid once size_ > 0.
+         */
+        size_t cutoff_;
+
+        /**
+         * @brief The number of the partition's Players until it next records its cutoff.
+         */
+        size_t until_report_;
+        size_t count_;
+    };
+
+    size_t reporting_interval_;
+    size_t count_;
+    FlatPartitionMap map_;
+    std::vector<Partition> partitions_;
+
+    /**
+     * @brief ids_[s] & cutoffs_[s] are the key & recorded cutoffs of the partition in slot s,
+     *        only read when it reports or finishes.
+     */
+    std::vector<uint64_t> ids_;
+    std::vector<CutoffSeries> cutoffs_;
+
+    /**
+     * @brief The pooled heaps: keys_[base_, base_ + size_) is a min-heap of RankKeys into pool_.
+     */
+    std::vector<RankKey> keys_;
+    std::vector<Player> pool_;
+
+    /**
+     * @brief Appends an empty partition for `partition` & returns its slot.
+     */
+    uint32_t addPartition(const uint64_t &partition);
+
+    /**
+     * @brief Adds `player` to the heap of `target`, evicting its minimum if it is full.
+     * @pre The heap is not full, or `player` beats its cutoff.
+     */
+    void admit(Partition &target, const Player &player);
+
+    /**
+     * @brief Records the cutoff of the partition in `slot` at its reporting boundary.
+     */
+    void report(const uint32_t &slot);
+};
+
+/**
+ * @brief rankIncoming() for every partition of one stream at once, routing each Player to
+ *        the leaderboard of partitionOf(player) in a single pass (see PartitionedLeaderboard).
+ *
+ * @param partitionOf A callable mapping a Player to its partition key (converted to uint64_t),
+ *      eg. [](const Player &player) { return player.id_ % regions; }
+ * @return A PartitionedRankingResult in which each partition's top_ & cutoffs_ match
+ *      rankIncoming() over that partition's Players alone, in stream order.
+ * @post All elements of the stream are read until there are none remaining.
+ */
+template <typename PartitionOf>
+PartitionedRankingResult rankIncomingPartitioned(PlayerStream &stream, const size_t &reporting_interval, PartitionOf partitionOf) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    RankingMetrics fetched;
+    PartitionedLeaderboard leaderboards(reporting_interval);
+    ChunkFetcher fetcher(stream, fetched);
+    for (PlayerChunk chunk = fetcher.next(); !chunk.empty(); chunk = fetcher.next()) {
+        leaderboards.ingest(chunk, partitionOf);
+    }
+    PartitionedRankingResult result = leaderboards.finish();
+    result.metrics_ = fetched;
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count() - result.metrics_.fetch_ms_;
+    return result;
+}
 }; // namespace Online
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "MmapPlayerStream.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Snapshots are read & written in the host's byte order, which must be little-endian"
+#endif
+
+namespace {
+/**
+ * @brief The number of entries each column buffers before writeSnapshot() flushes it.
+ */
+constexpr size_t WRITE_BUFFER = 1 << 16;
+
+/**
+ * @brief A column of the snapshot being written: a buffer & the file position it flushes to.
+ */
+template <typename T>
+struct ColumnWriter {
+    std::vector<T> buffer_;
+    uint64_t position_;
+
+    void flush(std::ofstream& out) {
+        out.seekp(position_);
+        out.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size() * sizeof(T));
+        position_ += buffer_.size() * sizeof(T);
+        buffer_.clear();
+    }
+
+    void push(std::ofstream& out, const T& value) {
+        buffer_.push_back(value);
+        if (buffer_.size() == WRITE_BUFFER) {
+            flush(out);
+        }
+    }
+};
+
+/**
+ * @brief Whether [offset, offset + length) lies within a file of `size` bytes, without overflowing.
+ */
+bool within(const uint64_t& offset, const uint64_t& length, const size_t& size) {
+    return offset <= size && length <= size - offset;
+}
+} // namespace
+
+void writeSnapshot(const std::string& path, PlayerStream& stream) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic_, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version_ = SNAPSHOT_VERSION;
+    header.count_ = stream.remaining();
+    header.levels_offset_ = sizeof(SnapshotHeader);
+    header.ids_offset_ = header.levels_offset_ + header.count_ * sizeof(uint64_t);
+    header.names_offset_ = header.ids_offset_ + header.count_ * sizeof(uint64_t);
+    header.blob_offset_ = header.names_offset_ + (header.count_ + 1) * sizeof(uint64_t);
+
+    ColumnWriter<uint64_t> levels{{}, header.levels_offset_};
+    ColumnWriter<uint64_t> ids{{}, header.ids_offset_};
+    ColumnWriter<uint64_t> names{{}, header.names_offset_};
+    ColumnWriter<char> blob{{}, header.blob_offset_};
+
+    uint64_t written = 0;
+    for (PlayerChunk chunk = stream.nextChunk(Online::CHUNK_SIZE); !chunk.empty(); chunk = stream.nextChunk(Online::CHUNK_SIZE)) {
+        for (const Player& player : chunk) {
+            levels.push(out, player.level_);
+            ids.push(out, player.id_);
+            names.push(out, header.blob_size_);
+            for (const char& c : player.name_) {
+                blob.push(out, c);
+            }
+            header.blob_size_ += player.name_.size();
+            written++;
+        }
+    }
+    if (written != header.count_) {
+        throw std::runtime_error("The stream yielded " + std::to_string(written) + " players, but reported " + std::to_string(header.count_));
+    }
+    names.push(out, header.blob_size_);
+
+    levels.flush(out);
+    ids.flush(out);
+    names.flush(out);
+    blob.flush(out);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Could not write " + path);
+    }
+}
+
+void writeSnapshot(const std::string& path, const std::vector<Player>& players) {
+    VectorPlayerStream stream = VectorPlayerStream::view(players);
+    writeSnapshot(path, stream);
+}
+
+MmapSnapshot::MmapSnapshot(const std::string& path)
+    : data_{nullptr}, size_{0}, header_{}, advice_{MADV_NORMAL} {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is too small to be a snapshot");
+    }
+    size_ = info.st_size;
+
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file open
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Could not map " + path + ": " + std::strerror(errno));
+    }
+    data_ = static_cast<const unsigned char*>(mapping);
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    const uint64_t count = header_.count_;
+    const bool valid = std::memcmp(header_.magic_, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 && header_.version_ == SNAPSHOT_VERSION &&
+                       count <= size_ / sizeof(uint64_t) &&
+                       header_.levels_offset_ % 8 == 0 && within(header_.levels_offset_, count * sizeof(uint64_t), size_) &&
+                       header_.ids_offset_ % 8 == 0 && within(header_.ids_offset_, count * sizeof(uint64_t), size_) &&
+                       header_.names_offset_ % 8 == 0 && within(header_.names_offset_, (count + 1) * sizeof(uint64_t), size_) &&
+                       within(header_.blob_offset_, header_.blob_size_, size_);
+    if (!valid) {
+        ::munmap(mapping, size_);
+        throw std::runtime_error(path + " is not a valid snapshot");
+    }
+}
+
+MmapSnapshot::~MmapSnapshot() {
+    ::munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+size_t MmapSnapshot::size() const {
+    return header_.count_;
+}
+
+const size_t* MmapSnapshot::levels() const {
+    return reinterpret_cast<const size_t*>(data_ + header_.levels_offset_);
+}
+
+const uint64_t* MmapSnapshot::ids() const {
+    return reinterpret_cast<const uint64_t*>(data_ + header_.ids_offset_);
+}
+
+std::string_view MmapSnapshot::name(const size_t& i) const {
+    const uint64_t* starts = reinterpret_cast<const uint64_t*>(data_ + header_.names_offset_);
+    const uint64_t first = starts[i], last = starts[i + 1];
+    if (first > last || last > header_.blob_size_) {
+        throw std::runtime_error("Snapshot name " + std::to_string(i) + " lies outside the name blob");
+    }
+    return {reinterpret_cast<const char*>(data_ + header_.blob_offset_ + first), last - first};
+}
+
+Player MmapSnapshot::player(const size_t& i) const {
+    return Player(std::string(name(i)), levels()[i], ids()[i]);
+}
+
+void MmapSnapshot::advise(const int& advice) const {
+    ::madvise(const_cast<unsigned char*>(data_), size_, advice);
+    advice_ = advice;
+}
+
+int MmapSnapshot::advice() const {
+    return advice_;
+}
+
+MmapPlayerStream::MmapPlayerStream(const MmapSnapshot& snapshot)
+    : snapshot_{snapshot}, next_{0}, previous_advice_{snapshot.advice()} {
+    snapshot_.advise(MADV_SEQUENTIAL);
+}
+
+MmapPlayerStream::~MmapPlayerStream() {
+    snapshot_.advise(previous_advice_);
+}
+
+Player MmapPlayerStream::nextPlayer() {
+    if (next_ >= snapshot_.size()) {
+        throw std::runtime_error("Out of Bounds.");
+    }
+    return snapshot_.player(next_++);
+}
+
+void MmapPlayerStream::readPlayer(Player& out) {
+    if (next_ >= snapshot_.size()) {
+        throw std::runtime_error("Out of Bounds.");
+    }
+    out.name_.assign(snapshot_.name(next_));
+    out.level_ = snapshot_.levels()[next_];
+    out.id_ = snapshot_.ids()[next_];
+    next_++;
+}
+
+size_t MmapPlayerStream::remaining() const {
+    return snapshot_.size() - next_;
+}
+
+namespace {
+/**
+ * @brief Builds the Players for `keys`, in order, from the snapshot.
+ */
+std::vector<Player> gather(const MmapSnapshot& snapshot, const std::vector<RankKey>& keys) {
+    std::vector<Player> players;
+    players.reserve(keys.size());
+    for (const RankKey& key : keys) {
+        players.push_back(snapshot.player(key.index_));
+    }
+    return players;
+}
+
+/**
+ * @brief Puts a snapshot's madvise() advice back when it goes out of scope.
+ */
+struct AdviceGuard {
+    const MmapSnapshot& snapshot_;
+    const int advice_;
+
+    ~AdviceGuard() { snapshot_.advise(advice_); }
+};
+} // namespace
+
+RankingResult Offline::rankSnapshotTopK(const MmapSnapshot& snapshot, const size_t& k) {
+    const auto t1 = std::chrono::high_resolution_clock::now();
+
+    const AdviceGuard restore{snapshot, snapshot.advice()};
+    snapshot.advise(MADV_SEQUENTIAL);
+    const size_t size = snapshot.size();
+    const LevelColumn levels(snapshot.levels(), size);
+    const size_t count = std::min(k, size);
+
+    std::vector<RankKey> top;
+    if (count > 0) {
+        const size_t maxLevel = *std::max_element(snapshot.levels(), snapshot.levels() + size);
+        if (maxLevel < COUNTING_LEVEL_THRESHOLD) {
+            top = countTopKeys(levels, count, maxLevel);
+        } else if (count <= size / PARTIAL_HEAP_DIVISOR) {
+            top = heapTopKeys(levels, count);
+        } else {
+            top = makeKeys(levels);
+            const auto first = top.end() - count;
+            std::nth_element(top.begin(), first, top.end());
+            std::sort(first, top.end());
+            top.erase(top.begin(), first);
+        }
+    }
+
+    // The top is gathered in level order, which jumps around the name blob
+    snapshot.advise(MADV_RANDOM);
+    RankingResult result(gather(snapshot, top));
+
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    result.elapsed_ = time.count();
+    return result;
+}
+
+RankingResult Offline::rankSnapshot(const MmapSnapshot& snapshot) {
+    return rankSnapshotTopK(snapshot, std::floor(0.1 * snapshot.size()));
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include "Leaderboard.hpp"
+#include "Player.hpp"
+#include "PlayerStream.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The on-disk layout of a Player snapshot, a columnar file that is ranked
+ *        & streamed through mmap without being deserialized.
+ *
+ * All integers are little-endian, & every section starts on an 8-byte boundary:
+ *
+ *  offset 0           -> SnapshotHeader
+ *  levels_offset_     -> uint64 level[count_]
+ *  ids_offset_        -> uint64 id[count_]
+ *  names_offset_      -> uint64 name_start[count_ + 1], offsets into the blob;
+ *                        Player i's name is blob[name_start[i], name_start[i + 1])
+ *  blob_offset_       -> char blob[blob_size_]
+ */
+struct SnapshotHeader {
+    /**
+     * @brief Identifies the file as a snapshot, SNAPSHOT_MAGIC.
+     */
+    char magic_[8];
+    uint32_t version_;
+    uint32_t reserved_;
+    uint64_t count_;
+    uint64_t levels_offset_;
+    uint64_t ids_offset_;
+    uint64_t names_offset_;
+    uint64_t blob_offset_;
+    uint64_t blob_size_;
+};
+
+constexpr char SNAPSHOT_MAGIC[8] = {'P', 'L', 'Y', 'R', 'S', 'N', 'A', 'P'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader must match the on-disk layout");
+static_assert(sizeof(size_t) == sizeof(uint64_t), "Snapshots map their level column straight onto size_t");
+
+/**
+ * @brief Writes every Player remaining in `stream` to a snapshot at `path`, replacing any file there.
+ *
+ * Streams through the Players once, buffering each column, so it needs O(1) memory
+ * beyond the stream itself.
+ *
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void writeSnapshot(const std::string& path, PlayerStream& stream);
+void writeSnapshot(const std::string& path, const std::vector<Player>& players);
+
+/**
+ * @brief A read-only memory mapping of a snapshot file.
+ *
+ * Opening one only maps & validates the header, so it takes the same time for any
+ * file size; pages are read in on first access.
+ */
+class MmapSnapshot {
+private:
+    const unsigned char* data_;
+    size_t size_;
+    SnapshotHeader header_;
+
+    /**
+     * @brief The advice last passed to advise(), MADV_NORMAL until then.
+     */
+    mutable int advice_;
+
+public:
+    /**
+     * @brief Maps the snapshot at `path`.
+     *
+     * @throws std::runtime_error If the file cannot be opened or mapped, or is not a valid snapshot.
+     */
+    explicit MmapSnapshot(const std::string& path);
+
+    ~MmapSnapshot();
+
+    MmapSnapshot(const MmapSnapshot&) = delete;
+    MmapSnapshot& operator=(const MmapSnapshot&) = delete;
+
+    /**
+     * @brief The number of Players in the snapshot.
+     */
+    size_t size() const;
+
+    /**
+     * @brief The level column, size() entries long.
+     */
+    const size_t* levels() const;
+
+    /**
+     * @brief The id column, size() entries long.
+     */
+    const uint64_t* ids() const;
+
+    /**
+     * @brief Returns the name of Player `i`, a view into the mapping.
+     */
+    std::string_view name(const size_t& i) const;
+
+    /**
+     * @brief Builds Player `i`.
+     */
+    Player player(const size_t& i) const;
+
+    /**
+     * @brief Passes `advice` (eg. MADV_SEQUENTIAL) to madvise() for the whole mapping.
+     * Advice is only a hint, so failures are ignored.
+     */
+    void advise(const int& advice) const;
+
+    /**
+     * @brief The advice last passed to advise(), so callers can put it back.
+     */
+    int advice() const;
+};
+
+/**
+ * @brief A PlayerStream that reads a snapshot's Players in order, straight from its mapping.
+ *
+ * Advises the kernel that the mapping will be read sequentially while the stream exists,
+ * so it reads ahead & drops pages behind the stream, & puts the previous advice back once it is destroyed.
+ */
+class MmapPlayerStream : public PlayerStream {
+private:
+    const MmapSnapshot& snapshot_;
+    size_t next_;
+
+    /**
+     * @brief The snapshot's advice before the stream was constructed.
+     */
+    int previous_advice_;
+
+public:
+    /**
+     * @pre `snapshot` outlives the stream.
+     */
+    explicit MmapPlayerStream(const MmapSnapshot& snapshot);
+
+    /**
+     * @brief Puts back the snapshot's advice from before the stream.
+     */
+    ~MmapPlayerStream() override;
+
+    MmapPlayerStream(const MmapPlayerStream&) = delete;
+    MmapPlayerStream& operator=(const MmapPlayerStream&) = delete;
+
+    /**
+     * @brief Retrieves the next Player in the stream.
+     *
+     * @throws std::runtime_error If there are no more players remaining in the stream.
+     */
+    Player nextPlayer() override;
+
+    /**
+     * @brief Reads the next Player into `out`, reusing its name's buffer.
+     *
+     * @throws std::runtime_error If there are no more players remaining in the stream.
+     */
+    void readPlayer(Player& out) override;
+
+    size_t remaining() const override;
+};
+
+namespace Offline {
+/**
+ * @brief Selects & sorts the top `k` players of a snapshot using only its level column,
+ *        then builds just those Players from the mapping.
+ *
+ * Levels below COUNTING_LEVEL_THRESHOLD are counted as in countingRank(), in O(K) extra memory.
+ * Otherwise, as rankTopK(): a partial heap of RankKeys for k up to N / PARTIAL_HEAP_DIVISOR,
+ * in O(k) memory, or a selection over a RankKey per Player, in O(N) memory.
+ * The snapshot's madvise() advice is put back once the top is gathered.
+ *
+ * @return A Ranking Result object whose
+ * - top_ vector -> Contains the top min(k, N) players of the snapshot in sorted order (ascending)
+ * - cutoffs_    -> Is empty
+ * - elapsed_    -> Contains the duration (ms) of the selection/sorting operation
+ */
+RankingResult rankSnapshotTopK(const MmapSnapshot& snapshot, const size_t& k);
+
+/**
+ * @brief rankSnapshotTopK() for the top 10% of players, matching heapRank() level-for-level.
+ */
+RankingResult rankSnapshot(const MmapSnapshot& snapshot);
+}; // namespace Offline
@@ -1,8 +1,11 @@
 #include "Player.hpp"
+#include <limits>
+#include <stdexcept>
 
-Player::Player(const std::string& name, const size_t& level)
+Player::Player(const std::string& name, const size_t& level, const size_t& id)
     : name_ { name }
     , level_ { level }
+    , id_ { id }
 {}
 
 bool Player::operator<(const Player& rhs) const
@@ -16,4 +19,79 @@ bool Player::operator==(const Player& rhs) const
 bool Player::operator>(const Player& rhs) const
 {
     return level_ > rhs.level_;
-}
\ No newline at end of file
+}
+
+uint32_t NameTable::intern(const std::string& name)
+{
+    auto found = handles_.find(name);
+    if (found != handles_.end()) {
+        return found->second;
+    }
+    if (names_.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("NameTable is full");
+    }
+
+    // A deque never relocates its elements on push_back, so the view stays valid
+    const uint32_t handle = names_.size();
+    names_.push_back(name);
+    handles_.emplace(names_.back(), handle);
+    return handle;
+}
+
+const std::string& NameTable::name(const uint32_t& handle) const
+{
+    return names_.at(handle);
+}
+
+size_t NameTable::size() const
+{
+    return names_.size();
+}
+
+NameTable& NameTable::shared()
+{
+    static NameTable table;
+    return table;
+}
+
+CompactPlayer::CompactPlayer(const uint32_t& name, const size_t& level, const uint32_t& id)
+    : name_ { name }
+    , id_ { id }
+    , level_ { level }
+{}
+
+CompactPlayer::CompactPlayer(const Player& player, NameTable& names)
+    : name_ { names.intern(player.name_) }
+    , id_ { 0 }
+    , level_ { player.level_ }
+{
+    if (player.id_ > std::numeric_limits<uint32_t>::max()) {
+        throw std::out_of_range("Player id does not fit in a CompactPlayer");
+    }
+    id_ = player.id_;
+}
+
+Player CompactPlayer::toPlayer(const NameTable& names) const
+{
+    return Player(names.name(name_), level_, id_);
+}
+
+std::vector<CompactPlayer> compact(const std::vector<Player>& players, NameTable& names)
+{
+    std::vector<CompactPlayer> result;
+    result.reserve(players.size());
+    for (const Player& player : players) {
+        result.emplace_back(player, names);
+    }
+    return result;
+}
+
+std::vector<Player> expand(const std::vector<CompactPlayer>& players, const NameTable& names)
+{
+    std::vector<Player> result;
+    result.reserve(players.size());
+    for (const CompactPlayer& player : players) {
+        result.push_back(player.toPlayer(names));
+    }
+    return result;
+}
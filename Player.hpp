@@ -1,5 +1,12 @@
 #pragma once
+#include <cstdint>
+#include <deque>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 struct Player {
     std::string name_;
@@ -10,8 +17,9 @@ struct Player {
     * @brief Constructs a Player with the given identifier.
     * @param name A const. string reference to be the player name
     * @param level The current level of the Player
+    * @param id An identifier for the Player, 0 if none
     */
-    Player(const std::string& name="NONE", const size_t& level = 1);
+    Player(const std::string& name="NONE", const size_t& level = 1, const size_t& id = 0);
 
     /**
      * @brief Defines convenience comparators for Players, 
@@ -21,3 +29,111 @@ struct Player {
     bool operator==(const Player& rhs) const;
     bool operator>(const Player& rhs) const;
 };
+
+/**
+ * @brief Projects a Player onto its level, the key Players are ranked by by default.
+ *
+ * Defined inline, unlike Player's operators, so the ranking templates that take a
+ * projection (eg. Offline::heapRankBy()) compile it down to a plain load.
+ */
+struct ByLevel {
+    constexpr size_t operator()(const Player& player) const noexcept { return player.level_; }
+};
+
+/**
+ * @brief Projects a Player onto (level, id), ranking by level & breaking ties by id.
+ */
+struct ByLevelThenId {
+    constexpr std::pair<size_t, size_t> operator()(const Player& player) const noexcept { return {player.level_, player.id_}; }
+};
+
+/**
+ * @brief Interns player names, handing out a stable 32-bit handle per distinct name.
+ *
+ * Handles index names in insertion order, & the strings never move once interned,
+ * so name(handle) references stay valid for the table's lifetime.
+ *
+ * @note Not thread-safe: intern() must not run concurrently with any other call.
+ */
+class NameTable {
+public:
+    NameTable() = default;
+
+    /**
+     * @brief Not copyable: handles_ views the strings in names_, so a copy would keep
+     *        reading the original's. Moving is safe, since a moved deque keeps its elements in place.
+     *        The moves are only as noexcept as the members' (libstdc++'s deque move constructor may allocate).
+     */
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+    NameTable(NameTable&&) = default;
+    NameTable& operator=(NameTable&&) = default;
+
+    /**
+     * @brief Returns the handle for `name`, interning it first if it is new.
+     * @throws std::length_error If the table already holds 2^32 names
+     */
+    uint32_t intern(const std::string& name);
+
+    /**
+     * @brief Returns the name interned as `handle`.
+     * @throws std::out_of_range If no name was interned as `handle`
+     */
+    const std::string& name(const uint32_t& handle) const;
+
+    size_t size() const;
+
+    /**
+     * @brief The table used by default by CompactPlayer conversions.
+     */
+    static NameTable& shared();
+
+private:
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, uint32_t> handles_;
+};
+
+/**
+ * @brief A 16-byte, trivially copyable Player, whose name lives in a NameTable.
+ *
+ * Swapping or moving one is a plain 16-byte copy, unlike a Player's std::string,
+ * so ranking CompactPlayers moves far less memory than ranking Players.
+ * Orders & compares by level, exactly like Player.
+ */
+struct CompactPlayer {
+    uint32_t name_;
+    uint32_t id_;
+    size_t level_;
+
+    CompactPlayer() = default;
+    CompactPlayer(const uint32_t& name, const size_t& level, const uint32_t& id = 0);
+
+    /**
+     * @brief Interns `player`'s name into `names`.
+     * @throws std::out_of_range If `player`'s id_ does not fit in 32 bits
+     */
+    explicit CompactPlayer(const Player& player, NameTable& names = NameTable::shared());
+
+    /**
+     * @brief Converts back to a Player, looking the name up in `names`,
+     *        which must be the table this CompactPlayer was interned into.
+     */
+    Player toPlayer(const NameTable& names = NameTable::shared()) const;
+
+    bool operator<(const CompactPlayer& rhs) const { return level_ < rhs.level_; }
+    bool operator==(const CompactPlayer& rhs) const { return level_ == rhs.level_; }
+    bool operator>(const CompactPlayer& rhs) const { return level_ > rhs.level_; }
+};
+
+static_assert(sizeof(CompactPlayer) == 16, "CompactPlayer should pack into 16 bytes");
+static_assert(std::is_trivially_copyable<CompactPlayer>::value, "CompactPlayer should be trivially copyable");
+
+/**
+ * @brief Converts a range of Players to CompactPlayers, interning their names into `names`.
+ */
+std::vector<CompactPlayer> compact(const std::vector<Player>& players, NameTable& names = NameTable::shared());
+
+/**
+ * @brief Converts a range of CompactPlayers back to Players.
+ */
+std::vector<Player> expand(const std::vector<CompactPlayer>& players, const NameTable& names = NameTable::shared());
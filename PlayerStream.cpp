@@ -1,18 +1,362 @@
 #include "PlayerStream.hpp"
 
-VectorPlayerStream::VectorPlayerStream(const std::vector<Player> &players) {
-    players_ = players;
-    currIndex = 0;
+void PlayerStream::readPlayer(Player &out) {
+    out = nextPlayer();
+}
+
+PlayerChunk PlayerStream::nextChunk(const size_t &max_count) {
+    const size_t count = std::min(max_count, remaining());
+    if (chunk_.size() < count) {
+        chunk_.resize(count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        readPlayer(chunk_[i]);
+    }
+
+    return {chunk_.data(), chunk_.data() + count};
+}
+
+double PlayerStream::stallTime() const {
+    return 0;
+}
+
+VectorPlayerStream::VectorPlayerStream(const std::vector<Player> &players)
+    : players_{players}, borrowed_{nullptr}, size_{players_.size()}, currIndex{0} {
+}
+
+VectorPlayerStream::VectorPlayerStream(std::vector<Player> &&players)
+    : players_{std::move(players)}, borrowed_{nullptr}, size_{players_.size()}, currIndex{0} {
+}
+
+VectorPlayerStream::VectorPlayerStream(const Player *first, const size_t &count)
+    : borrowed_{first}, size_{count}, currIndex{0} {
+}
+
+VectorPlayerStream VectorPlayerStream::view(const Player *first, const size_t &count) {
+    return VectorPlayerStream(first, count);
+}
+
+VectorPlayerStream VectorPlayerStream::view(const std::vector<Player> &players) {
+    return VectorPlayerStream(players.data(), players.size());
+}
+
+const Player *VectorPlayerStream::data() const {
+    return borrowed_ != nullptr ? borrowed_ : players_.data();
 }
 
 Player VectorPlayerStream::nextPlayer() {
-    if (currIndex >= players_.size()) {
+    if (currIndex >= size_) {
         throw std::runtime_error("Out of Bounds.");
     }
-    
-    return players_[currIndex++];
+
+    if (borrowed_ == nullptr) {
+        // We own this copy & never hand out the same index twice, so there's no need to copy it again
+        return std::move(players_[currIndex++]);
+    }
+    return borrowed_[currIndex++];
 }
 
 size_t VectorPlayerStream::remaining() const {
-    return players_.size() - currIndex;
-}
\ No newline at end of file
+    return size_ - currIndex;
+}
+
+PlayerChunk VectorPlayerStream::nextChunk(const size_t &max_count) {
+    const size_t count = std::min(max_count, remaining());
+    const Player *first = data() + currIndex;
+    currIndex += count;
+
+    return {first, first + count};
+}
+
+#ifdef API_ENABLED
+#include <chrono>
+#include <cpr/cpr.h>
+#include <cstdint>
+#include <deque>
+#include <nlohmann/json.hpp>
+#include <string_view>
+#include <utility>
+
+using json = nlohmann::json;
+
+APIPlayerStream::APIPlayerStream(const size_t &expected_length, const size_t &seed, const size_t &batch_size, const size_t &pipeline_depth)
+    : cursor_{1}, seed_{seed}, expected_length_{expected_length}, batch_size_{batch_size}, pipeline_depth_{pipeline_depth},
+      remaining_{expected_length}, ring_(RING_CAPACITY), head_{0}, filled_{0}, stopping_{false}, stallTime_{0}, stallCount_{0} {
+    fetcher_ = std::thread(&APIPlayerStream::fetchLoop, this);
+}
+
+APIPlayerStream::~APIPlayerStream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    notFull_.notify_all();
+    fetcher_.join();
+}
+
+void APIPlayerStream::fetchLoop() {
+    try {
+        // Each request in flight, with the number of levels it asked for
+        std::deque<std::pair<size_t, cpr::AsyncResponse>> inFlight;
+        std::vector<size_t> levels;
+        size_t requestCursor = cursor_;
+        size_t requested = 0;
+        size_t fetched = 0;
+
+        while (fetched < expected_length_) {
+            // Top the pipeline back up before waiting on the oldest request
+            while (inFlight.size() < pipeline_depth_ && requested < expected_length_) {
+                const size_t batch = std::min(batch_size_, expected_length_ - requested);
+                inFlight.emplace_back(batch, cpr::GetAsync(cpr::Url{SOCKET + "/api"},
+                                                           cpr::Parameters{{"seed", std::to_string(seed_)},
+                                                                           {"cursor", std::to_string(requestCursor)},
+                                                                           {"batch", std::to_string(batch)}},
+                                                           cpr::Timeout{REQUEST_TIMEOUT}));
+                requestCursor += batch;
+                requested += batch;
+            }
+
+            if (inFlight.empty()) {
+                throw std::runtime_error("API requests ran out after " + std::to_string(fetched) + " of " + std::to_string(expected_length_) + " levels");
+            }
+            const size_t batch = inFlight.front().first;
+            cpr::Response response = inFlight.front().second.get();
+            inFlight.pop_front();
+            if (response.status_code != 200) {
+                throw std::runtime_error("API request failed with status " + std::to_string(response.status_code) + ": " + response.error.message);
+            }
+
+            const json body = json::parse(response.text);
+            levels.clear();
+            for (const auto &level : body.at("levels")) {
+                levels.push_back(level.template get<size_t>());
+            }
+            // A short batch would leave levels that were counted as requested but never fetched
+            if (levels.size() != batch) {
+                throw std::runtime_error("API returned " + std::to_string(levels.size()) + " levels for a batch of " + std::to_string(batch) +
+                                         " at cursor " + std::to_string(cursor_));
+            }
+            cursor_ = body.at("cursor").template get<size_t>();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < levels.size();) {
+                notFull_.wait(lock, [this] { return stopping_ || filled_ < ring_.size(); });
+                if (stopping_) {
+                    return;
+                }
+
+                for (; i < levels.size() && filled_ < ring_.size(); ++i, ++filled_) {
+                    ring_[(head_ + filled_) % ring_.size()] = levels[i];
+                }
+                notEmpty_.notify_one();
+            }
+            fetched += levels.size();
+        }
+    } catch (const std::exception &e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = e.what();
+        notEmpty_.notify_all();
+    }
+}
+
+void APIPlayerStream::awaitLevels(std::unique_lock<std::mutex> &lock) {
+    if (filled_ == 0) {
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        notEmpty_.wait(lock, [this] { return filled_ > 0 || !error_.empty(); });
+        const auto t2 = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> time = t2 - t1;
+        stallTime_ += time.count();
+        stallCount_++;
+    }
+
+    if (filled_ == 0) {
+        throw std::runtime_error(error_);
+    }
+}
+
+Player APIPlayerStream::nextPlayer() {
+    if (remaining_ == 0) {
+        throw std::runtime_error("Out of Bounds.");
+    }
+
+    size_t level;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        awaitLevels(lock);
+        level = ring_[head_];
+        head_ = (head_ + 1) % ring_.size();
+        filled_--;
+    }
+    notFull_.notify_one();
+
+    remaining_--;
+    return Player(PLAYER_NAME, level);
+}
+
+size_t APIPlayerStream::remaining() const {
+    return remaining_;
+}
+
+PlayerChunk APIPlayerStream::nextChunk(const size_t &max_count) {
+    size_t count = std::min(max_count, remaining_);
+    if (count == 0) {
+        return {nullptr, nullptr};
+    }
+
+    // Growing with a named prototype means steady-state chunks only overwrite levels
+    chunk_.resize(std::max(chunk_.size(), count), Player(PLAYER_NAME));
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        awaitLevels(lock);
+        count = std::min(count, filled_);
+        for (size_t i = 0; i < count; ++i) {
+            chunk_[i].level_ = ring_[head_];
+            head_ = (head_ + 1) % ring_.size();
+        }
+        filled_ -= count;
+    }
+    notFull_.notify_one();
+
+    remaining_ -= count;
+    return {chunk_.data(), chunk_.data() + count};
+}
+
+double APIPlayerStream::stallTime() const {
+    return stallTime_;
+}
+
+size_t APIPlayerStream::stallCount() const {
+    return stallCount_;
+}
+
+BulkAPIPlayerStream::BulkAPIPlayerStream(const size_t &expected_length, const size_t &seed, const size_t &segment_size)
+    : cursor_{1}, seed_{seed}, expected_length_{expected_length}, segment_size_{segment_size}, remaining_{expected_length},
+      requested_{0}, next_{0} {
+    prefetch();
+}
+
+BulkAPIPlayerStream::~BulkAPIPlayerStream() {
+    if (pending_.valid()) {
+        pending_.wait();
+    }
+}
+
+void BulkAPIPlayerStream::prefetch() {
+    if (requested_ == expected_length_) {
+        return;
+    }
+
+    const size_t cursor = 1 + requested_;
+    const size_t count = std::min(segment_size_, expected_length_ - requested_);
+    requested_ += count;
+    pending_ = std::async(std::launch::async, [this, cursor, count] { fetchSegment(cursor, count, prefetched_); });
+}
+
+void BulkAPIPlayerStream::fetchSegment(const size_t &cursor, const size_t &count, std::vector<size_t> &out) const {
+    out.clear();
+    out.reserve(count);
+
+    // Frames may be split anywhere across callbacks, so carry partial words between them
+    uint32_t word = 0;
+    size_t wordBytes = 0;
+    size_t frameLeft = 0;
+    bool finished = false;
+    bool malformed = false;
+
+    auto decode = [&](std::string_view data, intptr_t) {
+        const unsigned char *curr = reinterpret_cast<const unsigned char *>(data.data());
+        const unsigned char *last = curr + data.size();
+        while (curr != last && !malformed) {
+            if (wordBytes == 0 && last - curr >= 4) {
+                word = uint32_t(curr[0]) | uint32_t(curr[1]) << 8 | uint32_t(curr[2]) << 16 | uint32_t(curr[3]) << 24;
+                curr += 4;
+            } else {
+                word |= uint32_t(*curr++) << (8 * wordBytes);
+                if (++wordBytes < 4) {
+                    continue;
+                }
+                wordBytes = 0;
+            }
+
+            if (finished) {
+                malformed = true;
+            } else if (frameLeft > 0) {
+                out.push_back(word);
+                frameLeft--;
+            } else if (word == 0) {
+                finished = true;
+            } else {
+                frameLeft = word;
+            }
+            word = 0;
+        }
+        return !malformed;
+    };
+
+    const cpr::Response response = cpr::Get(cpr::Url{SOCKET + "/api/bulk"},
+                                            cpr::Parameters{{"seed", std::to_string(seed_)},
+                                                            {"cursor", std::to_string(cursor)},
+                                                            {"count", std::to_string(count)}},
+                                            cpr::Timeout{REQUEST_TIMEOUT},
+                                            cpr::WriteCallback{decode});
+    if (response.status_code != 200) {
+        throw std::runtime_error("Bulk API request failed with status " + std::to_string(response.status_code) + ": " + response.error.message);
+    }
+    const auto next = response.header.find("X-Next-Cursor");
+    if (malformed || !finished || wordBytes != 0 || out.size() != count ||
+        next == response.header.end() || next->second != std::to_string(cursor + count)) {
+        throw std::runtime_error("Bulk API returned a malformed response at cursor " + std::to_string(cursor));
+    }
+}
+
+void BulkAPIPlayerStream::awaitLevels() {
+    if (next_ < levels_.size()) {
+        return;
+    }
+
+    if (!error_.empty()) {
+        throw std::runtime_error(error_);
+    }
+    try {
+        pending_.get();
+    } catch (const std::exception &e) {
+        // get() leaves pending_ invalid, so later reads rethrow the same failure instead
+        error_ = e.what();
+        throw std::runtime_error(error_);
+    }
+    cursor_ += levels_.size();
+    std::swap(levels_, prefetched_);
+    next_ = 0;
+    prefetch();
+}
+
+Player BulkAPIPlayerStream::nextPlayer() {
+    if (remaining_ == 0) {
+        throw std::runtime_error("Out of Bounds.");
+    }
+
+    awaitLevels();
+    remaining_--;
+    return Player(PLAYER_NAME, levels_[next_++]);
+}
+
+size_t BulkAPIPlayerStream::remaining() const {
+    return remaining_;
+}
+
+PlayerChunk BulkAPIPlayerStream::nextChunk(const size_t &max_count) {
+    if (remaining_ == 0 || max_count == 0) {
+        return {nullptr, nullptr};
+    }
+
+    awaitLevels();
+    const size_t count = std::min({max_count, remaining_, levels_.size() - next_});
+    chunk_.resize(std::max(chunk_.size(), count), Player(PLAYER_NAME));
+    for (size_t i = 0; i < count; ++i) {
+        chunk_[i].level_ = levels_[next_++];
+    }
+
+    remaining_ -= count;
+    return {chunk_.data(), chunk_.data() + count};
+}
+#endif
\ No newline at end of file
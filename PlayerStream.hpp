@@ -1,5 +1,6 @@
 #pragma once
 #include "Player.hpp"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -8,13 +9,47 @@
 
 // Uncomment the following if you're doing extra credit!
 // Otherwise, feel free to ignore this or erase APIPlayerStream.
+// NOTE: CMakeLists.txt defines this for you, since it is the build that links cpr & nlohmann_json.
 // #define API_ENABLED
 
+#ifdef API_ENABLED
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @brief A read-only view over a contiguous run of Players handed out by a PlayerStream.
+ *
+ * A chunk does not own its Players. It is only valid until the next call to
+ * nextPlayer() or nextChunk() on the stream that produced it.
+ */
+struct PlayerChunk {
+    const Player* begin_;
+    const Player* end_;
+
+    const Player* begin() const { return begin_; }
+    const Player* end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+};
+
 /**
  * @brief Interface for fetching Player objects sequentially.
  */
 class PlayerStream {
+protected:
+    /**
+     * @brief Backing storage for the default nextChunk(), reused between calls.
+     * It only ever grows, so its Players (& their names' buffers) are recycled
+     * from one chunk to the next instead of being reallocated.
+     */
+    std::vector<Player> chunk_;
+
 public:
+    virtual ~PlayerStream() = default;
+
     /**
      * @brief Retrieves the next Player in the stream, if possible.
      *
@@ -29,12 +64,44 @@ public:
 
     virtual Player nextPlayer() = 0;
 
+    /**
+     * @brief Reads the next Player in the stream into `out`, reusing `out`'s storage.
+     *
+     * The default implementation assigns nextPlayer() to `out`. Streams that decode
+     * Players should override this to assign each field in place, so reading into
+     * a recycled Player performs no allocations.
+     *
+     * @throws std::runtime_error, if there are no more players to fetch.
+     */
+    virtual void readPlayer(Player& out);
+
     /**
      * @brief Returns the number of players remaining in the stream.
 
      * @return The count of players left to be read.
      */
     virtual size_t remaining() const = 0;
+
+    /**
+     * @brief Retrieves up to `max_count` of the next Players in the stream at once.
+     *
+     * Lets consumers pay for one virtual call per chunk instead of per Player.
+     * The default implementation drains readPlayer() into a recycled buffer;
+     * streams backed by contiguous storage should override it to hand out
+     * a view of that storage without copying.
+     *
+     * @param max_count The largest number of Players to return
+     * @return A view of min(max_count, remaining()) Players, in stream order.
+     *      The view is empty once the stream is exhausted.
+     * @post A subsequent call yields the Players following the returned chunk.
+     */
+    virtual PlayerChunk nextChunk(const size_t& max_count);
+
+    /**
+     * @brief Returns the total time the consumer has spent blocked waiting for Players to arrive, in ms.
+     * Streams that never wait on anything (the default) return 0.
+     */
+    virtual double stallTime() const;
 };
 
 /**
@@ -58,7 +125,18 @@ class VectorPlayerStream : public PlayerStream {
 private:
     // Your private members here. You're the designer now!
     std::vector<Player> players_;
-    int currIndex;
+
+    /**
+     * @brief The borrowed Players when constructed through view(), otherwise nullptr.
+     * Owning streams always read from `players_`, so they stay valid when copied.
+     */
+    const Player* borrowed_;
+    size_t size_;
+    size_t currIndex;
+
+    VectorPlayerStream(const Player* first, const size_t& count);
+
+    const Player* data() const;
 public:
     /**
      * @brief Constructs a VectorPlayerStream from a vector of Players.
@@ -70,10 +148,39 @@ public:
      */
     VectorPlayerStream(const std::vector<Player>& players);
 
+    /**
+     * @brief Constructs a VectorPlayerStream that takes ownership of a vector of Players
+     *        without copying it.
+     *
+     * @param players The vector of Player objects to stream. Left empty.
+     */
+    VectorPlayerStream(std::vector<Player>&& players);
+
+    /**
+     * @brief Constructs a non-owning VectorPlayerStream over Players held by the caller.
+     *
+     * Nothing is copied up front; nextChunk() hands out views of the caller's
+     * Players, so replaying a snapshot performs no allocations per Player.
+     *
+     * @pre The viewed Players outlive the stream & are not modified while it is read.
+     *
+     * @param first A pointer to the first Player to stream
+     * @param count The number of contiguous Players to stream
+     * @return A stream yielding the viewed Players in order.
+     */
+    static VectorPlayerStream view(const Player* first, const size_t& count);
+    static VectorPlayerStream view(const std::vector<Player>& players);
+
+    /**
+     * @brief Viewing a temporary vector would leave the stream dangling; construct an owning stream instead.
+     */
+    static VectorPlayerStream view(std::vector<Player>&& players) = delete;
+
     /**
     * @brief Retrieves the next Player in the stream.
     *
     * @return The next Player object in the sequence.
+    *   Owning streams move it out of their storage; views copy it.
     * @post Updates members so a subsequent call to nextPlayer() yields the Player
     * following that which is returned.
 
@@ -87,4 +194,312 @@ public:
      * @return The count of players left to be read.
      */
     size_t remaining() const override; // see how many instances remaining to be fetched
-};
\ No newline at end of file
+
+    /**
+     * @brief Returns a view of up to `max_count` of the next Players
+     *        directly from the underlying storage, without copying them.
+     *
+     * @param max_count The largest number of Players to return
+     * @return A view of min(max_count, remaining()) Players, in stream order.
+     */
+    PlayerChunk nextChunk(const size_t& max_count) override;
+};
+
+#ifdef API_ENABLED
+/**
+ * @brief A PlayerStream implementation that fetches Player objects from an API in batches.
+ *
+ * Specifically, this retrieves Player objects localhost (127.0.0.1) at port 5000 using HTTP requests
+ * to fetch subequent batches of Players of specified size, by querying:
+ * http://127.0.0.1:5000/api?seed={POSITIVE NUMBER}&cursor={CURSOR}&batch={BATCH_SIZE}
+ *
+ * The server caps the batch size (see `BATCH_CUTOFF` in server/server.py), so one request
+ * at a time leaves the consumer waiting on a round trip every few Players. Instead,
+ * a background thread keeps up to `pipeline_depth` requests in flight & writes the
+ * fetched levels into a ring buffer that nextPlayer() / nextChunk() drain.
+ *
+ * Time the consumer spends blocked on an empty ring buffer is recorded,
+ * see stallTime() & stallCount().
+ */
+class APIPlayerStream : public PlayerStream {
+protected:
+    const std::string PORT = "5000";
+    const std::string HOSTNAME = "http://127.0.0.1";
+    const std::string SOCKET = HOSTNAME + ":" + PORT;
+
+    /**
+     * @brief The name given to every Player built from a fetched level.
+     */
+    const std::string PLAYER_NAME = "API";
+
+    /**
+     * @brief The number of levels the ring buffer between the fetching thread & the consumer can hold.
+     */
+    static constexpr size_t RING_CAPACITY = 4096;
+
+    /**
+     * @brief How long a single request may take before the stream fails, in ms.
+     */
+    static constexpr int REQUEST_TIMEOUT = 5000;
+
+private:
+    /**
+     * @brief Imagine you're querying from a database and there's millions of results
+     * Instead, of returning all million of them, we'll periodically fetch a batch of them,
+     * and store where in that sequence of million results we're at.
+     * `cursor_` is *exactly* this. Think of it like the page number on Google search.
+     *
+     * Only the fetching thread reads or writes it once the stream is constructed.
+     */
+    size_t cursor_;
+
+    /**
+     * @brief Since we're not working with an actual database,
+     * we'll use seeds to pseudo-randomly generate contents.
+     * Make sure to include this in your calls.
+     */
+    size_t seed_;
+
+    size_t expected_length_;
+    size_t batch_size_;
+    size_t pipeline_depth_;
+
+    /**
+     * @brief The number of Players not yet handed to the consumer.
+     */
+    size_t remaining_;
+
+    /**
+     * @brief Fetched levels waiting to be read, stored in [head_, head_ + filled_) modulo the capacity.
+     * Guarded by `mutex_`, as are `filled_`, `stopping_` & `error_`.
+     */
+    std::vector<size_t> ring_;
+    size_t head_;
+    size_t filled_;
+
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+
+    /**
+     * @brief Set by the destructor to tell the fetching thread to exit.
+     */
+    bool stopping_;
+
+    /**
+     * @brief The reason the fetching thread stopped early, empty if it has not failed.
+     */
+    std::string error_;
+
+    double stallTime_;
+    size_t stallCount_;
+
+    std::thread fetcher_;
+
+    /**
+     * @brief The body of the fetching thread. Issues requests for consecutive cursors,
+     * keeping `pipeline_depth_` of them in flight, & appends their levels to the ring
+     * buffer in cursor order until `expected_length_` levels have been fetched.
+     */
+    void fetchLoop();
+
+    /**
+     * @brief Blocks until the ring buffer holds at least one level, recording the stall.
+     *
+     * @throws std::runtime_error If the fetching thread failed before delivering more levels.
+     */
+    void awaitLevels(std::unique_lock<std::mutex>& lock);
+
+public:
+    /**
+     * @brief Constructs an APIPlayerStream that fetches Players from an API and presents the contents as a stream
+     *
+     * @pre All parameters are positive (ie. > 0).
+     *
+     * @param expected_length The total number of Player objects expected from the API.
+     * @param seed A seed value used for API requests to ensure consistent results
+     * @param batch_size The number of Player objects to fetch in each API request.
+     * @param pipeline_depth The number of API requests kept in flight at once.
+     *
+     * @post
+     * a) `cursor_` is initialized to 1
+     * b) `seed_` is initialized to the provided seed value.
+     * c) A background thread has started fetching the first batches.
+     */
+    APIPlayerStream(const size_t& expected_length, const size_t& seed, const size_t& batch_size = 5, const size_t& pipeline_depth = 8);
+
+    /**
+     * @brief Stops the fetching thread, abandoning any requests still in flight.
+     */
+    ~APIPlayerStream() override;
+
+    APIPlayerStream(const APIPlayerStream&) = delete;
+    APIPlayerStream& operator=(const APIPlayerStream&) = delete;
+
+    /**
+    * @brief Retrieves the next Player in the stream.
+    *
+    * @details Takes the next fetched level from the ring buffer, blocking until the
+    * fetching thread delivers it if the buffer is empty.
+    *
+    * @return The next Player object in the sequence.
+    * @throws std::runtime_error If there are no more players remaining or if the API request fails.
+    */
+    Player nextPlayer() override;
+
+    /**
+     * @brief Returns the number of players remaining in the stream.
+     *
+     * @return The count of players left to be read.
+     * @example If our stream is initialized with expected length 5,
+     *   after calling nextPlayer() twice, we'll have 3 players remaining.
+     */
+    size_t remaining() const override;
+
+    /**
+     * @brief Retrieves up to `max_count` Players at once, taking every level
+     *        already in the ring buffer & only blocking when it is empty.
+     *
+     * @param max_count The largest number of Players to return
+     * @return A view of at least one & at most min(max_count, remaining()) Players,
+     *      empty only once the stream is exhausted.
+     * @throws std::runtime_error If the API request fails.
+     */
+    PlayerChunk nextChunk(const size_t& max_count) override;
+
+    /**
+     * @brief Returns the total time the consumer has spent blocked waiting on the network, in ms.
+     */
+    double stallTime() const override;
+
+    /**
+     * @brief Returns the number of reads that found the ring buffer empty & had to wait.
+     */
+    size_t stallCount() const;
+};
+
+/**
+ * @brief A PlayerStream that fetches levels in large segments from the server's bulk endpoint:
+ * http://127.0.0.1:5000/api/bulk?seed={POSITIVE NUMBER}&cursor={CURSOR}&count={SEGMENT_SIZE}
+ *
+ * The endpoint answers with binary frames rather than JSON: each frame is a little-endian
+ * uint32 length N followed by N little-endian uint32 levels, & a frame of length 0 ends
+ * the response. Frames are decoded as the bytes arrive, straight into a level buffer.
+ *
+ * While the consumer drains one segment, the next is fetched in the background,
+ * so a stream pays one round trip per `segment_size` Players & rarely waits on it.
+ */
+class BulkAPIPlayerStream : public PlayerStream {
+protected:
+    const std::string PORT = "5000";
+    const std::string HOSTNAME = "http://127.0.0.1";
+    const std::string SOCKET = HOSTNAME + ":" + PORT;
+
+    /**
+     * @brief The name given to every Player built from a fetched level.
+     */
+    const std::string PLAYER_NAME = "API";
+
+    /**
+     * @brief How long fetching a single segment may take before the stream fails, in ms.
+     */
+    static constexpr int REQUEST_TIMEOUT = 30000;
+
+private:
+    /**
+     * @brief The cursor of the first level in `levels_`.
+     */
+    size_t cursor_;
+    size_t seed_;
+    size_t expected_length_;
+    size_t segment_size_;
+    size_t remaining_;
+
+    /**
+     * @brief The number of levels requested so far, including the segment being prefetched.
+     */
+    size_t requested_;
+
+    /**
+     * @brief The segment currently being read, & the index of its next unread level.
+     */
+    std::vector<size_t> levels_;
+    size_t next_;
+
+    /**
+     * @brief The segment being fetched in the background by `pending_`.
+     */
+    std::vector<size_t> prefetched_;
+    std::future<void> pending_;
+
+    /**
+     * @brief The failure of a segment fetch, if one has failed; every later read rethrows it.
+     */
+    std::string error_;
+
+    /**
+     * @brief Starts fetching the segment following those already requested, if any are left.
+     */
+    void prefetch();
+
+    /**
+     * @brief Fetches & decodes `count` levels beginning at `cursor` into `out`.
+     *
+     * @throws std::runtime_error If the request fails, or the response is malformed
+     *         or its X-Next-Cursor header is not the cursor following those levels.
+     */
+    void fetchSegment(const size_t& cursor, const size_t& count, std::vector<size_t>& out) const;
+
+    /**
+     * @brief Ensures `levels_` has an unread level, swapping in the prefetched segment if needed.
+     *
+     * @throws std::runtime_error If the prefetched segment, or any before it, failed to fetch.
+     */
+    void awaitLevels();
+
+public:
+    /**
+     * @brief Constructs a BulkAPIPlayerStream & begins fetching its first segment.
+     *
+     * @pre All parameters are positive (ie. > 0).
+     *
+     * @param expected_length The total number of Player objects expected from the API.
+     * @param seed A seed value used for API requests to ensure consistent results
+     * @param segment_size The number of levels to fetch in each bulk request.
+     */
+    BulkAPIPlayerStream(const size_t& expected_length, const size_t& seed, const size_t& segment_size = 1 << 16);
+
+    /**
+     * @brief Waits for any segment still being fetched.
+     */
+    ~BulkAPIPlayerStream() override;
+
+    BulkAPIPlayerStream(const BulkAPIPlayerStream&) = delete;
+    BulkAPIPlayerStream& operator=(const BulkAPIPlayerStream&) = delete;
+
+    /**
+     * @brief Retrieves the next Player in the stream.
+     *
+     * @return The next Player object in the sequence.
+     * @throws std::runtime_error If there are no more players remaining or if the API request fails.
+     */
+    Player nextPlayer() override;
+
+    /**
+     * @brief Returns the number of players remaining in the stream.
+     *
+     * @return The count of players left to be read.
+     */
+    size_t remaining() const override;
+
+    /**
+     * @brief Retrieves up to `max_count` Players from the current segment at once.
+     *
+     * @param max_count The largest number of Players to return
+     * @return A view of at least one & at most min(max_count, remaining()) Players,
+     *      empty only once the stream is exhausted.
+     * @throws std::runtime_error If the API request fails.
+     */
+    PlayerChunk nextChunk(const size_t& max_count) override;
+};
+#endif
\ No newline at end of file
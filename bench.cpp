@@ -0,0 +1,913 @@
+#include "AsyncPlayerStream.hpp"
+#include "Leaderboard.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Benchmark harness for the ranking algorithms.
+ *
+ * Runs every algorithm over every input distribution for each input size,
+ * & prints one row per (algorithm, distribution, size) with the median & p99
+ * wall time across repetitions, the median throughput, the median number of heap
+ * allocations per repetition & the process's peak RSS so far.
+ *
+ * Usage: ./bench [--suite ranking|readers|scan|topk|heap|metrics|partitions|compact|parallel] [--min-n N] [--max-n N] [--reps R]
+ *                [--interval R] [--publish-every P] [--name-length L] [--threads T] [--seed S] [--json]
+ *   Sizes run from --min-n to --max-n in powers of 10 (default 1e3 ... 1e6).
+ *   Player names are padded to at least --name-length characters (default 0, ie. unpadded),
+ *   so names past the small-string limit show up in the allocation counts.
+ *
+ * Suites:
+ *   ranking -> The above (default).
+ *   readers -> Ingest throughput of an Online::Leaderboard publishing every --publish-every
+ *              intervals, while 0, 8 & 64 threads poll its published cutoff & snapshot.
+ *   scan    -> Scalar vs. dispatched Online::findAbove() over chunks of uniform levels,
+ *              against the cutoff a leaderboard of --interval Players would have after n of them.
+ *   topk    -> Offline::rankTopFraction() over uniform levels for top fractions from 0.01% to 50%,
+ *              with each Selection, to locate the PartialHeap / SelectSort crossover.
+ *   heap    -> Online::rankIncoming() over uniform & sorted levels for leaderboards of 1e3, 1e5 &
+ *              1e7 Players (those no larger than n), with the binary Player heap & 2-, 4- & 8-ary key heaps.
+ *   metrics -> Online::rankIncoming() with each Backend over every distribution, printing its
+ *              RankingMetrics as JSON. Only fetch_ms & stall_ms are filled in unless built with METRICS=1.
+ *   partitions -> Online::rankIncomingPartitioned() over uniform levels split into 1, 16 & 256 partitions
+ *              by id, against one Online::Leaderboard pass per partition over the same Players.
+ *   compact -> Offline::heapRank() over Players vs. Offline::heapRankCompact() over the same input
+ *              compacted into CompactPlayers beforehand, for every distribution.
+ *   parallel -> Offline::parallelRank(), Offline::stableRank() & Online::parallelRankIncoming() over uniform
+ *              & sorted levels with 1, 2, 4, ... threads up to --threads (default: the hardware's thread count),
+ *              with each row's speedup over the same algorithm on 1 thread.
+ */
+
+/**
+ * @brief The number of calls to operator new so far, counted by the replacements below.
+ * Every form is replaced, including new[] & the aligned forms CacheAlignedAllocator goes through.
+ */
+std::atomic<size_t> allocations{0};
+
+namespace {
+void *allocate(size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *allocate(size_t size, std::align_val_t alignment) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    // aligned_alloc() needs a size that is a multiple of the alignment
+    const size_t align = static_cast<size_t>(alignment);
+    return std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+}
+} // namespace
+
+void *operator new(size_t size) {
+    if (void *memory = allocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    if (void *memory = allocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    if (void *memory = allocate(size, alignment)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    if (void *memory = allocate(size, alignment)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return allocate(size, alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return allocate(size, alignment);
+}
+
+// malloc() & aligned_alloc() memory are both released by free(), so every delete is the same
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+struct Options {
+    std::string suite_ = "ranking";
+    size_t min_n_ = 1000;
+    size_t max_n_ = 1000000;
+    size_t reps_ = 5;
+    size_t interval_ = 100;
+    size_t publish_every_ = 10;
+    size_t name_length_ = 0;
+    size_t threads_ = std::max(1u, std::thread::hardware_concurrency());
+    size_t seed_ = 1;
+    bool json_ = false;
+};
+
+struct Distribution {
+    std::string name_;
+    std::function<size_t(size_t i, size_t n)> level_;
+};
+
+struct Algorithm {
+    std::string name_;
+
+    /**
+     * @brief Ranks a scratch copy of the input, which it may modify.
+     */
+    std::function<void(std::vector<Player> &players, const Options &options)> run_;
+
+    /**
+     * @brief Whether the algorithm accepts `players`; empty if it accepts any input.
+     */
+    std::function<bool(const std::vector<Player> &players)> accepts_ = nullptr;
+};
+
+struct Row {
+    std::string algorithm_;
+    std::string distribution_;
+    size_t n_;
+    size_t reps_;
+    double median_;
+    double p99_;
+    double throughput_;
+    size_t allocations_;
+    long peakRss_;
+};
+
+std::vector<Distribution> distributions(const Options &options) {
+    auto rng = std::make_shared<std::mt19937_64>(options.seed_);
+    const size_t seed = options.seed_;
+    return {
+        {"uniform", [rng](size_t, size_t) { return (*rng)() % 1000000000; }},
+        {"sorted", [](size_t i, size_t) { return i; }},
+        {"reversed", [](size_t i, size_t n) { return n - i; }},
+        {"equal", [](size_t, size_t) { return size_t(42); }},
+        // Matches server/server.py's get_pseudorandom, cursors starting at 1
+        {"modular", [seed](size_t i, size_t) { return seed * (i + 1) * 3 % 1381; }},
+    };
+}
+
+/**
+ * @brief A stream that only implements nextPlayer(), like one decoding Players off the network,
+ *        so reading it in chunks goes through PlayerStream's default nextChunk().
+ */
+class DecodingPlayerStream : public PlayerStream {
+private:
+    const std::vector<Player> &players_;
+    size_t next_;
+
+public:
+    explicit DecodingPlayerStream(const std::vector<Player> &players) : players_{players}, next_{0} {}
+
+    Player nextPlayer() override {
+        if (next_ >= players_.size()) {
+            throw std::runtime_error("Out of Bounds.");
+        }
+        return players_[next_++];
+    }
+
+    /**
+     * @brief Decodes straight into the recycled Player, as a real decoding stream would.
+     */
+    void readPlayer(Player &out) override {
+        if (next_ >= players_.size()) {
+            throw std::runtime_error("Out of Bounds.");
+        }
+        out.name_ = players_[next_].name_;
+        out.level_ = players_[next_].level_;
+        out.id_ = players_[next_].id_;
+        next_++;
+    }
+
+    size_t remaining() const override {
+        return players_.size() - next_;
+    }
+};
+
+std::vector<Algorithm> algorithms() {
+    return {
+        {"heapRank", [](std::vector<Player> &players, const Options &) { Offline::heapRank(players); }},
+        {"quickSelectRank", [](std::vector<Player> &players, const Options &) { Offline::quickSelectRank(players); }},
+        {"countingRank", [](std::vector<Player> &players, const Options &) { Offline::countingRank(players); },
+         [](const std::vector<Player> &players) {
+             return std::all_of(players.begin(), players.end(), [](const Player &player) { return player.level_ < Offline::COUNTING_LEVEL_THRESHOLD; });
+         }},
+        {"rank", [](std::vector<Player> &players, const Options &) { Offline::rank(players); }},
+        {"stableRank", [](std::vector<Player> &players, const Options &) { Offline::stableRank(players); }},
+        {"rankIncoming", [](std::vector<Player> &players, const Options &options) {
+             VectorPlayerStream stream = VectorPlayerStream::view(players);
+             Online::rankIncoming(stream, options.interval_);
+         }},
+        {"rankIncomingAsync", [](std::vector<Player> &players, const Options &options) {
+             VectorPlayerStream source = VectorPlayerStream::view(players);
+             AsyncStreamAdapter stream(source);
+             Online::rankIncomingAsync(stream, options.interval_);
+         }},
+        {"rankIncomingStable", [](std::vector<Player> &players, const Options &options) {
+             VectorPlayerStream stream = VectorPlayerStream::view(players);
+             Online::rankIncomingStable(stream, options.interval_);
+         }},
+        {"rankIncomingDecoded", [](std::vector<Player> &players, const Options &options) {
+             DecodingPlayerStream stream(players);
+             Online::rankIncoming(stream, options.interval_);
+         }},
+        {"windowed", [](std::vector<Player> &players, const Options &options) {
+             // The top --interval of the last 10 * --interval Players
+             Online::WindowedLeaderboard leaderboard(options.interval_, 10 * options.interval_);
+             for (const Player &player : players) {
+                 leaderboard.ingest(player);
+             }
+         }},
+    };
+}
+
+std::vector<Player> generate(const Distribution &distribution, size_t n, const Options &options) {
+    std::vector<Player> players;
+    players.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        std::string name = "P" + std::to_string(i);
+        if (name.size() < options.name_length_) {
+            name.append(options.name_length_ - name.size(), '_');
+        }
+        players.emplace_back(name, distribution.level_(i, n));
+    }
+    return players;
+}
+
+long peakRss() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // KiB on Linux
+}
+
+/**
+ * @brief Returns the p-th percentile (nearest-rank) of `samples`, which it sorts.
+ */
+double percentile(std::vector<double> &samples, double p) {
+    std::sort(samples.begin(), samples.end());
+    const size_t rank = std::ceil(p / 100.0 * samples.size());
+    return samples[std::max<size_t>(rank, 1) - 1];
+}
+
+Row measure(const Algorithm &algorithm, const Distribution &distribution, const std::vector<Player> &input, const Options &options) {
+    std::vector<double> samples;
+    std::vector<size_t> counts;
+    for (size_t rep = 0; rep < options.reps_; ++rep) {
+        std::vector<Player> players = input;
+
+        const size_t before = allocations.load(std::memory_order_relaxed);
+        const auto t1 = std::chrono::steady_clock::now();
+        algorithm.run_(players, options);
+        const auto t2 = std::chrono::steady_clock::now();
+        counts.push_back(allocations.load(std::memory_order_relaxed) - before);
+        const std::chrono::duration<double, std::milli> time = t2 - t1;
+        samples.push_back(time.count());
+    }
+
+    const double median = percentile(samples, 50);
+    const double p99 = percentile(samples, 99);
+    std::sort(counts.begin(), counts.end());
+    return {algorithm.name_, distribution.name_, input.size(), options.reps_, median, p99, input.size() / (median / 1000),
+            counts[counts.size() / 2], peakRss()};
+}
+
+void printHeader(const Options &options) {
+    if (!options.json_) {
+        std::printf("algorithm,distribution,n,reps,median_ms,p99_ms,players_per_sec,allocations,peak_rss_kb\n");
+    }
+}
+
+void printRow(const Row &row, const Options &options, bool first) {
+    if (options.json_) {
+        std::printf("%s{\"algorithm\":\"%s\",\"distribution\":\"%s\",\"n\":%zu,\"reps\":%zu,"
+                    "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f,\"allocations\":%zu,\"peak_rss_kb\":%ld}",
+                    first ? "[\n  " : ",\n  ", row.algorithm_.c_str(), row.distribution_.c_str(), row.n_, row.reps_,
+                    row.median_, row.p99_, row.throughput_, row.allocations_, row.peakRss_);
+    } else {
+        std::printf("%s,%s,%zu,%zu,%.4f,%.4f,%.0f,%zu,%ld\n", row.algorithm_.c_str(), row.distribution_.c_str(), row.n_, row.reps_,
+                    row.median_, row.p99_, row.throughput_, row.allocations_, row.peakRss_);
+    }
+    std::fflush(stdout);
+}
+
+Options parse(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&]() -> size_t {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(std::string("Missing value for ") + argv[i]);
+            }
+            return std::stoull(argv[++i]);
+        };
+
+        if (std::strcmp(argv[i], "--min-n") == 0) {
+            options.min_n_ = value();
+            if (options.min_n_ == 0) {
+                // Sizes step up by multiplying by 10, so they would never leave 0
+                throw std::invalid_argument("--min-n must be positive");
+            }
+        } else if (std::strcmp(argv[i], "--max-n") == 0) {
+            options.max_n_ = value();
+        } else if (std::strcmp(argv[i], "--reps") == 0) {
+            options.reps_ = std::max<size_t>(1, value());
+        } else if (std::strcmp(argv[i], "--interval") == 0) {
+            options.interval_ = std::max<size_t>(1, value());
+        } else if (std::strcmp(argv[i], "--publish-every") == 0) {
+            options.publish_every_ = value();
+        } else if (std::strcmp(argv[i], "--name-length") == 0) {
+            options.name_length_ = value();
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            options.threads_ = std::max<size_t>(1, value());
+        } else if (std::strcmp(argv[i], "--suite") == 0) {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for --suite");
+            }
+            options.suite_ = argv[++i];
+            if (options.suite_ != "ranking" && options.suite_ != "readers" && options.suite_ != "scan" && options.suite_ != "topk" && options.suite_ != "heap" && options.suite_ != "metrics" &&
+                options.suite_ != "partitions" && options.suite_ != "compact" && options.suite_ != "parallel") {
+                throw std::invalid_argument("Unknown suite " + options.suite_);
+            }
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            options.seed_ = value();
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            options.json_ = true;
+        } else {
+            throw std::invalid_argument(std::string("Unknown option ") + argv[i]);
+        }
+    }
+    return options;
+}
+
+/**
+ * @brief Times a single writer ingesting `input` into a publishing Leaderboard
+ *        while `readers` threads poll it, returning the writer's time (ms) & the reads performed.
+ */
+std::pair<double, size_t> ingestWithReaders(const std::vector<Player> &input, unsigned readers, const Options &options) {
+    Online::Leaderboard leaderboard(options.interval_, options.publish_every_);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> reads{0};
+    std::atomic<size_t> checksum{0}; // Keeps the reads from being optimized away
+
+    std::vector<std::thread> pollers;
+    for (unsigned i = 0; i < readers; ++i) {
+        pollers.emplace_back([&] {
+            size_t local = 0, sink = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                sink += leaderboard.publishedCutoff();
+                if (auto snapshot = leaderboard.published()) {
+                    sink += snapshot->top_.size();
+                }
+                local++;
+            }
+            reads.fetch_add(local);
+            checksum.fetch_add(sink);
+        });
+    }
+
+    VectorPlayerStream stream = VectorPlayerStream::view(input);
+    const auto t1 = std::chrono::steady_clock::now();
+    for (PlayerChunk chunk = stream.nextChunk(Online::CHUNK_SIZE); !chunk.empty(); chunk = stream.nextChunk(Online::CHUNK_SIZE)) {
+        leaderboard.ingest(chunk);
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    done = true;
+    for (std::thread &poller : pollers) {
+        poller.join();
+    }
+    const std::chrono::duration<double, std::milli> time = t2 - t1;
+    return {time.count(), reads.load()};
+}
+
+void runReaders(const Options &options) {
+    if (!options.json_) {
+        std::printf("readers,n,interval,publish_every,reps,median_ms,p99_ms,players_per_sec,reads_per_sec\n");
+    }
+
+    bool first = true;
+    const Distribution uniform = distributions(options).front();
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        const std::vector<Player> input = generate(uniform, n, options);
+        for (unsigned readers : {0u, 8u, 64u}) {
+            std::vector<double> samples;
+            double reads = 0;
+            for (size_t rep = 0; rep < options.reps_; ++rep) {
+                const auto [time, count] = ingestWithReaders(input, readers, options);
+                samples.push_back(time);
+                reads += count / (time / 1000);
+            }
+
+            const double median = percentile(samples, 50);
+            const double p99 = percentile(samples, 99);
+            if (options.json_) {
+                std::printf("%s{\"readers\":%u,\"n\":%zu,\"interval\":%zu,\"publish_every\":%zu,\"reps\":%zu,"
+                            "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f,\"reads_per_sec\":%.0f}",
+                            first ? "[\n  " : ",\n  ", readers, n, options.interval_, options.publish_every_, options.reps_,
+                            median, p99, n / (median / 1000), reads / options.reps_);
+            } else {
+                std::printf("%u,%zu,%zu,%zu,%zu,%.4f,%.4f,%.0f,%.0f\n", readers, n, options.interval_, options.publish_every_,
+                            options.reps_, median, p99, n / (median / 1000), reads / options.reps_);
+            }
+            std::fflush(stdout);
+            first = false;
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+}
+
+void runScan(const Options &options) {
+    if (!options.json_) {
+        std::printf("kernel,n,interval,reps,median_ms,p99_ms,players_per_sec,survivors\n");
+    }
+
+    using Kernel = const Player *(*)(const Player *, const Player *, const size_t &);
+    const std::pair<const char *, Kernel> kernels[] = {{"scalar", Online::findAboveScalar}, {"dispatched", Online::findAbove}};
+
+    bool first = true;
+    const Distribution uniform = distributions(options).front();
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        const std::vector<Player> input = generate(uniform, n, options);
+        VectorPlayerStream stream = VectorPlayerStream::view(input);
+        const RankingResult ranking = Online::rankIncoming(stream, options.interval_);
+        const size_t threshold = ranking.top_.empty() ? 0 : ranking.top_.front().level_;
+        for (const auto &[name, kernel] : kernels) {
+            std::vector<double> samples;
+            size_t survivors = 0;
+            for (size_t rep = 0; rep < options.reps_; ++rep) {
+                survivors = 0;
+                const auto t1 = std::chrono::steady_clock::now();
+                for (size_t start = 0; start < n; start += Online::CHUNK_SIZE) {
+                    const Player *last = input.data() + std::min(n, start + Online::CHUNK_SIZE);
+                    for (const Player *curr = kernel(input.data() + start, last, threshold); curr != last; curr = kernel(curr + 1, last, threshold)) {
+                        survivors++;
+                    }
+                }
+                const auto t2 = std::chrono::steady_clock::now();
+                const std::chrono::duration<double, std::milli> time = t2 - t1;
+                samples.push_back(time.count());
+            }
+
+            const double median = percentile(samples, 50);
+            const double p99 = percentile(samples, 99);
+            if (options.json_) {
+                std::printf("%s{\"kernel\":\"%s\",\"n\":%zu,\"interval\":%zu,\"reps\":%zu,"
+                            "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f,\"survivors\":%zu}",
+                            first ? "[\n  " : ",\n  ", name, n, options.interval_, options.reps_, median, p99, n / (median / 1000), survivors);
+            } else {
+                std::printf("%s,%zu,%zu,%zu,%.4f,%.4f,%.0f,%zu\n", name, n, options.interval_, options.reps_, median, p99,
+                            n / (median / 1000), survivors);
+            }
+            std::fflush(stdout);
+            first = false;
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+}
+
+void runTopK(const Options &options) {
+    if (!options.json_) {
+        std::printf("selection,n,fraction,reps,median_ms,p99_ms,players_per_sec\n");
+    }
+
+    const std::pair<const char *, Selection> selections[] = {
+        {"PartialHeap", Selection::PartialHeap}, {"SelectSort", Selection::SelectSort}, {"Auto", Selection::Auto}};
+
+    bool first = true;
+    const Distribution uniform = distributions(options).front();
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        const std::vector<Player> input = generate(uniform, n, options);
+        for (double fraction : {0.0001, 0.001, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5}) {
+            for (const auto &[name, selection] : selections) {
+                std::vector<double> samples;
+                for (size_t rep = 0; rep < options.reps_; ++rep) {
+                    std::vector<Player> players = input;
+                    const auto t1 = std::chrono::steady_clock::now();
+                    Offline::rankTopFraction(players, fraction, selection);
+                    const auto t2 = std::chrono::steady_clock::now();
+                    const std::chrono::duration<double, std::milli> time = t2 - t1;
+                    samples.push_back(time.count());
+                }
+
+                const double median = percentile(samples, 50);
+                const double p99 = percentile(samples, 99);
+                if (options.json_) {
+                    std::printf("%s{\"selection\":\"%s\",\"n\":%zu,\"fraction\":%g,\"reps\":%zu,"
+                                "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f}",
+                                first ? "[\n  " : ",\n  ", name, n, fraction, options.reps_, median, p99, n / (median / 1000));
+                } else {
+                    std::printf("%s,%zu,%g,%zu,%.4f,%.4f,%.0f\n", name, n, fraction, options.reps_, median, p99, n / (median / 1000));
+                }
+                std::fflush(stdout);
+                first = false;
+            }
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+}
+
+void runHeap(const Options &options) {
+    if (!options.json_) {
+        std::printf("heap,distribution,n,interval,reps,median_ms,p99_ms,players_per_sec\n");
+    }
+
+    struct Heap {
+        const char *name_;
+        Backend backend_;
+        unsigned arity_;
+    };
+    const Heap heaps[] = {{"objects-2", Backend::Objects, 2}, {"keys-2", Backend::Keys, 2}, {"keys-4", Backend::Keys, 4}, {"keys-8", Backend::Keys, 8}};
+
+    bool first = true;
+    const std::vector<Distribution> all = distributions(options);
+    const Distribution chosen[] = {all[0], all[1]}; // uniform, & sorted, where every Player is admitted
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        for (const Distribution &distribution : chosen) {
+            const std::vector<Player> input = generate(distribution, n, options);
+            for (size_t interval : {size_t(1000), size_t(100000), size_t(10000000)}) {
+                if (interval > n) {
+                    continue;
+                }
+                for (const Heap &heap : heaps) {
+                    std::vector<double> samples;
+                    for (size_t rep = 0; rep < options.reps_; ++rep) {
+                        VectorPlayerStream stream = VectorPlayerStream::view(input);
+                        const auto t1 = std::chrono::steady_clock::now();
+                        Online::rankIncoming(stream, interval, heap.backend_, heap.arity_);
+                        const auto t2 = std::chrono::steady_clock::now();
+                        const std::chrono::duration<double, std::milli> time = t2 - t1;
+                        samples.push_back(time.count());
+                    }
+
+                    const double median = percentile(samples, 50);
+                    const double p99 = percentile(samples, 99);
+                    if (options.json_) {
+                        std::printf("%s{\"heap\":\"%s\",\"distribution\":\"%s\",\"n\":%zu,\"interval\":%zu,\"reps\":%zu,"
+                                    "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f}",
+                                    first ? "[\n  " : ",\n  ", heap.name_, distribution.name_.c_str(), n, interval, options.reps_, median, p99,
+                                    n / (median / 1000));
+                    } else {
+                        std::printf("%s,%s,%zu,%zu,%zu,%.4f,%.4f,%.0f\n", heap.name_, distribution.name_.c_str(), n, interval, options.reps_, median,
+                                    p99, n / (median / 1000));
+                    }
+                    std::fflush(stdout);
+                    first = false;
+                }
+            }
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+}
+
+void runMetrics(const Options &options) {
+    if (!METRICS_ENABLED) {
+        std::fprintf(stderr, "Built without LEADERBOARD_METRICS (make METRICS=1), so only fetch_ms & stall_ms are filled in\n");
+    }
+
+    bool first = true;
+    const std::pair<const char *, Backend> backends[] = {{"objects", Backend::Objects}, {"keys", Backend::Keys}};
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        for (const Distribution &distribution : distributions(options)) {
+            const std::vector<Player> input = generate(distribution, n, options);
+            for (const auto &[name, backend] : backends) {
+                VectorPlayerStream stream = VectorPlayerStream::view(input);
+                const RankingResult result = Online::rankIncoming(stream, options.interval_, backend);
+                std::printf("%s{\"backend\":\"%s\",\"distribution\":\"%s\",\"n\":%zu,\"interval\":%zu,\"elapsed_ms\":%.4f,\"metrics\":%s}",
+                            first ? "[\n  " : ",\n  ", name, distribution.name_.c_str(), n, options.interval_, result.elapsed_,
+                            result.metrics_.toJson().c_str());
+                std::fflush(stdout);
+                first = false;
+            }
+        }
+    }
+    std::printf("%s]\n", first ? "[" : "\n");
+}
+
+void runPartitions(const Options &options) {
+    if (!options.json_) {
+        std::printf("engine,partitions,n,interval,reps,median_ms,p99_ms,players_per_sec\n");
+    }
+
+    bool first = true;
+    const Distribution uniform = distributions(options)[0];
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        std::vector<Player> input = generate(uniform, n, options);
+        for (size_t i = 0; i < n; ++i) {
+            input[i].id_ = i;
+        }
+        for (size_t partitions : {size_t(1), size_t(16), size_t(256)}) {
+            auto partitionOf = [partitions](const Player &player) { return player.id_ % partitions; };
+            const std::pair<const char *, std::function<void()>> engines[] = {
+                {"single-pass",
+                 [&] {
+                     VectorPlayerStream stream = VectorPlayerStream::view(input);
+                     Online::rankIncomingPartitioned(stream, options.interval_, partitionOf);
+                 }},
+                // What running rankIncoming() once per partition costs: every pass reads the whole stream
+                {"pass-per-partition",
+                 [&] {
+                     for (size_t partition = 0; partition < partitions; ++partition) {
+                         Online::Leaderboard leaderboard(options.interval_);
+                         VectorPlayerStream stream = VectorPlayerStream::view(input);
+                         for (PlayerChunk chunk = stream.nextChunk(Online::CHUNK_SIZE); !chunk.empty(); chunk = stream.nextChunk(Online::CHUNK_SIZE)) {
+                             for (const Player &player : chunk) {
+                                 if (partitionOf(player) == partition) {
+                                     leaderboard.ingest(player);
+                                 }
+                             }
+                         }
+                         leaderboard.finish();
+                     }
+                 }},
+            };
+
+            for (const auto &[name, run] : engines) {
+                std::vector<double> samples;
+                for (size_t rep = 0; rep < options.reps_; ++rep) {
+                    const auto t1 = std::chrono::steady_clock::now();
+                    run();
+                    const auto t2 = std::chrono::steady_clock::now();
+                    const std::chrono::duration<double, std::milli> time = t2 - t1;
+                    samples.push_back(time.count());
+                }
+
+                const double median = percentile(samples, 50);
+                const double p99 = percentile(samples, 99);
+                if (options.json_) {
+                    std::printf("%s{\"engine\":\"%s\",\"partitions\":%zu,\"n\":%zu,\"interval\":%zu,\"reps\":%zu,"
+                                "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f}",
+                                first ? "[\n  " : ",\n  ", name, partitions, n, options.interval_, options.reps_, median, p99, n / (median / 1000));
+                } else {
+                    std::printf("%s,%zu,%zu,%zu,%zu,%.4f,%.4f,%.0f\n", name, partitions, n, options.interval_, options.reps_, median, p99,
+                                n / (median / 1000));
+                }
+                std::fflush(stdout);
+                first = false;
+            }
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+}
+
+void runCompact(const Options &options) {
+    if (!options.json_) {
+        std::printf("record,distribution,n,reps,median_ms,p99_ms,players_per_sec\n");
+    }
+
+    bool first = true;
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        for (const Distribution &distribution : distributions(options)) {
+            const std::vector<Player> input = generate(distribution, n, options);
+            // Interned once, outside the timed region, as a caller keeping CompactPlayers would
+            NameTable names;
+            const std::vector<CompactPlayer> compacted = compact(input, names);
+            std::vector<Player> players;
+            std::vector<CompactPlayer> compactPlayers;
+            struct Record {
+                const char *name_;
+                std::function<void()> reset_; // Refills the scratch copy, outside the timed region
+                std::function<void()> run_;
+            };
+            const Record records[] = {
+                {"Player", [&] { players = std::vector<Player>(input); }, [&] { Offline::heapRank(players); }},
+                {"CompactPlayer", [&] { compactPlayers = std::vector<CompactPlayer>(compacted); }, [&] { Offline::heapRankCompact(compactPlayers, names); }},
+            };
+
+            for (const Record &record : records) {
+                std::vector<double> samples;
+                for (size_t rep = 0; rep < options.reps_; ++rep) {
+                    record.reset_();
+                    const auto t1 = std::chrono::steady_clock::now();
+                    record.run_();
+                    const auto t2 = std::chrono::steady_clock::now();
+                    const std::chrono::duration<double, std::milli> time = t2 - t1;
+                    samples.push_back(time.count());
+                }
+
+                const double median = percentile(samples, 50);
+                const double p99 = percentile(samples, 99);
+                if (options.json_) {
+                    std::printf("%s{\"record\":\"%s\",\"distribution\":\"%s\",\"n\":%zu,\"reps\":%zu,"
+                                "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f}",
+                                first ? "[\n  " : ",\n  ", record.name_, distribution.name_.c_str(), n, options.reps_, median, p99, n / (median / 1000));
+                } else {
+                    std::printf("%s,%s,%zu,%zu,%.4f,%.4f,%.0f\n", record.name_, distribution.name_.c_str(), n, options.reps_, median, p99,
+                                n / (median / 1000));
+                }
+                std::fflush(stdout);
+                first = false;
+            }
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+}
+
+void runParallel(const Options &options) {
+    if (!options.json_) {
+        std::printf("algorithm,distribution,n,threads,reps,median_ms,p99_ms,players_per_sec,speedup\n");
+    }
+
+    // 1, 2, 4, ... threads, ending on --threads itself even if it isn't a power of 2
+    std::vector<unsigned> threadCounts;
+    for (size_t threads = 1; threads < options.threads_; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(options.threads_);
+
+    const std::pair<const char *, std::function<void(std::vector<Player> &, unsigned)>> algorithms[] = {
+        {"parallelRank", [](std::vector<Player> &players, unsigned threads) { Offline::parallelRank(players, threads); }},
+        {"stableRank", [](std::vector<Player> &players, unsigned threads) { Offline::stableRank(players, TieBreak::Position, threads); }},
+        {"parallelRankIncoming", [&options](std::vector<Player> &players, unsigned threads) {
+             VectorPlayerStream stream = VectorPlayerStream::view(players);
+             Online::parallelRankIncoming(stream, options.interval_, threads);
+         }},
+    };
+
+    bool first = true;
+    const std::vector<Distribution> all = distributions(options);
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        for (const Distribution &distribution : {all[0], all[1]}) {
+            const std::vector<Player> input = generate(distribution, n, options);
+            for (const auto &[name, run] : algorithms) {
+                double single = 0;
+                for (const unsigned threads : threadCounts) {
+                    std::vector<double> samples;
+                    for (size_t rep = 0; rep < options.reps_; ++rep) {
+                        std::vector<Player> players = input;
+                        const auto t1 = std::chrono::steady_clock::now();
+                        run(players, threads);
+                        const auto t2 = std::chrono::steady_clock::now();
+                        const std::chrono::duration<double, std::milli> time = t2 - t1;
+                        samples.push_back(time.count());
+                    }
+
+                    const double median = percentile(samples, 50);
+                    const double p99 = percentile(samples, 99);
+                    if (threads == 1) {
+                        single = median;
+                    }
+                    if (options.json_) {
+                        std::printf("%s{\"algorithm\":\"%s\",\"distribution\":\"%s\",\"n\":%zu,\"threads\":%u,\"reps\":%zu,"
+                                    "\"median_ms\":%.4f,\"p99_ms\":%.4f,\"players_per_sec\":%.0f,\"speedup\":%.2f}",
+                                    first ? "[\n  " : ",\n  ", name, distribution.name_.c_str(), n, threads, options.reps_, median, p99,
+                                    n / (median / 1000), single / median);
+                    } else {
+                        std::printf("%s,%s,%zu,%u,%zu,%.4f,%.4f,%.0f,%.2f\n", name, distribution.name_.c_str(), n, threads, options.reps_, median, p99,
+                                    n / (median / 1000), single / median);
+                    }
+                    std::fflush(stdout);
+                    first = false;
+                }
+            }
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    try {
+        options = parse(argc, argv);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    if (options.suite_ == "readers") {
+        runReaders(options);
+        return 0;
+    }
+    if (options.suite_ == "scan") {
+        runScan(options);
+        return 0;
+    }
+    if (options.suite_ == "topk") {
+        runTopK(options);
+        return 0;
+    }
+    if (options.suite_ == "heap") {
+        runHeap(options);
+        return 0;
+    }
+    if (options.suite_ == "metrics") {
+        runMetrics(options);
+        return 0;
+    }
+    if (options.suite_ == "partitions") {
+        runPartitions(options);
+        return 0;
+    }
+    if (options.suite_ == "compact") {
+        runCompact(options);
+        return 0;
+    }
+    if (options.suite_ == "parallel") {
+        runParallel(options);
+        return 0;
+    }
+
+    bool first = true;
+    printHeader(options);
+    for (size_t n = options.min_n_; n <= options.max_n_; n *= 10) {
+        for (const Distribution &distribution : distributions(options)) {
+            const std::vector<Player> input = generate(distribution, n, options);
+            for (const Algorithm &algorithm : algorithms()) {
+                if (algorithm.accepts_ && !algorithm.accepts_(input)) {
+                    continue;
+                }
+                printRow(measure(algorithm, distribution, input, options), options, first);
+                first = false;
+            }
+        }
+    }
+    if (options.json_) {
+        std::printf("%s]\n", first ? "[" : "\n");
+    }
+    return 0;
+}
@@ -1,10 +1,14 @@
 #!/usr/bin/env python3
 
-from flask import Flask, request, jsonify, abort
+import struct
+
+from flask import Flask, Response, request, jsonify, abort
 
 app = Flask(__name__)
 PRIME_WRAPPER = 1381
 BATCH_CUTOFF = 10
+BULK_CUTOFF = 1 << 24
+FRAME_SIZE = 4096
 
 
 def get_pseudorandom(seed: int, cursor: int):
@@ -47,6 +51,58 @@ def get_next_item():
     return jsonify(response)
 
 
+@app.route("/api/bulk", methods=["GET"])
+def get_bulk_items():
+    """
+    Streams `count` levels starting at `cursor` as a sequence of binary frames.
+
+    Each frame is a little-endian uint32 length N followed by N little-endian
+    uint32 levels. A frame of length 0 terminates the response. The cursor
+    following the last level is sent in the X-Next-Cursor header.
+    """
+    seed = request.args.get("seed", default=None, type=int)
+    cursor = request.args.get("cursor", default=None, type=int)
+    count = request.args.get("count", default=None, type=int)
+
+    app.logger.info(
+        f"Received bulk request with seed: {seed}, cursor: {cursor}, count: {count}"
+    )
+
+    if seed is None or cursor is None or count is None:
+        abort(
+            400,
+            f"Invalid request data, received seed={seed}, cursor={cursor}, count={count}",
+        )
+
+    if count > BULK_CUTOFF:
+        abort(400, f"Your count is too big: {count}")
+
+    if count <= 0:
+        abort(400, f"Your count is too low: {count}")
+
+    if cursor < 1:
+        abort(400, f"Your cursor is too low: {cursor}")
+
+    if seed < 1:
+        abort(400, f"Your seed is too low: {seed}")
+
+    def frames():
+        start = cursor
+        end = cursor + count
+        while start < end:
+            size = min(FRAME_SIZE, end - start)
+            levels = (get_pseudorandom(seed, c) for c in range(start, start + size))
+            yield struct.pack(f"<I{size}I", size, *levels)
+            start += size
+        yield struct.pack("<I", 0)
+
+    return Response(
+        frames(),
+        mimetype="application/octet-stream",
+        headers={"X-Next-Cursor": str(cursor + count)},
+    )
+
+
 @app.errorhandler(404)
 def catch_all(e):
     return f"You're querying the wrong endpoint: {request.path}. On the bright side, you're connected!"
@@ -0,0 +1,254 @@
+#include "Leaderboard.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Tests for the stateful online leaderboards, whose invariants the benchmark doesn't check.
+ *
+ * Usage: ./tests
+ *   Runs every test, printing each failed check, & exits non-zero if any failed.
+ *
+ * Tests:
+ *   updatable   -> UpdatableLeaderboard level changes & erasures crossing between its two heaps,
+ *                  by hand & against a brute-force model.
+ *   windowed    -> WindowedLeaderboard expiry by count & by age, by hand & against a brute-force window.
+ *   partitioned -> PartitionedLeaderboard's per-partition tops & cutoffs against rankIncoming()
+ *                  over each partition alone.
+ */
+
+namespace {
+size_t failures = 0;
+
+#define CHECK(condition)                                                           \
+    do {                                                                           \
+        if (!(condition)) {                                                        \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                            \
+        }                                                                          \
+    } while (false)
+
+/**
+ * @brief The levels of `players`, in order.
+ */
+std::vector<size_t> levels(const std::vector<Player> &players) {
+    std::vector<size_t> out;
+    for (const Player &player : players) {
+        out.push_back(player.level_);
+    }
+    return out;
+}
+
+/**
+ * @brief The highest `r` of `all`, in ascending order.
+ */
+std::vector<size_t> topLevels(std::vector<size_t> all, const size_t &r) {
+    std::sort(all.begin(), all.end());
+    all.erase(all.begin(), all.end() - std::min(r, all.size()));
+    return all;
+}
+
+void testUpdatableCrossOver() {
+    Online::UpdatableLeaderboard leaderboard(2);
+    leaderboard.upsert(Player("A", 10, 1));
+    leaderboard.upsert(Player("B", 20, 2));
+    leaderboard.upsert(Player("C", 5, 3));
+    CHECK(levels(leaderboard.snapshot()) == (std::vector<size_t>{10, 20}));
+    CHECK(leaderboard.cutoff() == 10);
+
+    // C rises past the cutoff, so it swaps places with A, the top's minimum
+    leaderboard.updateLevel(3, 30);
+    CHECK(levels(leaderboard.snapshot()) == (std::vector<size_t>{20, 30}));
+    CHECK(leaderboard.cutoff() == 20);
+
+    // B falls below A, the best player outside the top, so they swap back
+    leaderboard.updateLevel(2, 1);
+    CHECK(levels(leaderboard.snapshot()) == (std::vector<size_t>{10, 30}));
+    CHECK(leaderboard.cutoff() == 10);
+
+    // Moving within the top or within the rest crosses nothing
+    leaderboard.updateLevel(1, 15);
+    leaderboard.updateLevel(2, 2);
+    CHECK(levels(leaderboard.snapshot()) == (std::vector<size_t>{15, 30}));
+
+    // Erasing from the top promotes the best of the rest; erasing from the rest leaves the top alone
+    leaderboard.upsert(Player("D", 7, 4));
+    CHECK(leaderboard.erase(3));
+    CHECK(levels(leaderboard.snapshot()) == (std::vector<size_t>{7, 15}));
+    CHECK(leaderboard.erase(2));
+    CHECK(levels(leaderboard.snapshot()) == (std::vector<size_t>{7, 15}));
+    CHECK(!leaderboard.erase(2));
+    CHECK(leaderboard.playerCount() == 2);
+
+    CHECK(leaderboard.erase(4));
+    CHECK(leaderboard.size() == 1);
+    CHECK(leaderboard.at(1).name_ == "A");
+
+    bool threw = false;
+    try {
+        leaderboard.updateLevel(3, 1);
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+void testUpdatableAgainstModel() {
+    std::mt19937_64 rng(335);
+    for (const size_t r : {1, 3, 16}) {
+        Online::UpdatableLeaderboard leaderboard(r);
+        std::map<size_t, size_t> model; // id -> level
+
+        for (size_t step = 0; step < 20000; ++step) {
+            const size_t id = rng() % 64, level = rng() % 100;
+            switch (rng() % 3) {
+            case 0:
+                leaderboard.upsert(Player("P", level, id));
+                model[id] = level;
+                break;
+            case 1:
+                if (model.count(id) != 0) {
+                    leaderboard.updateLevel(id, level);
+                    model[id] = level;
+                }
+                break;
+            default:
+                CHECK(leaderboard.erase(id) == (model.erase(id) == 1));
+            }
+
+            std::vector<size_t> all;
+            for (const auto &[known, known_level] : model) {
+                all.push_back(known_level);
+            }
+            const std::vector<size_t> expected = topLevels(all, r);
+            CHECK(levels(leaderboard.snapshot()) == expected);
+            CHECK(leaderboard.cutoff() == (expected.empty() ? 0 : expected.front()));
+            CHECK(leaderboard.playerCount() == model.size());
+        }
+    }
+}
+
+void testWindowedExpiry() {
+    using Clock = Online::WindowedLeaderboard::Clock;
+
+    // By count: only the 3 most recent Players can be ranked
+    Online::WindowedLeaderboard recent(2, 3);
+    for (const size_t level : {50, 40, 30, 20}) {
+        recent.ingest(Player("P", level));
+    }
+    CHECK(recent.windowSize() == 3);
+    CHECK(levels(recent.snapshot()) == (std::vector<size_t>{30, 40}));
+    recent.ingest(Player("P", 10));
+    CHECK(levels(recent.snapshot()) == (std::vector<size_t>{20, 30}));
+    CHECK(recent.cutoff() == 20);
+
+    // By age: a Player leaves max_age after it was ingested, even without new arrivals
+    const Clock::time_point start{};
+    Online::WindowedLeaderboard aged(2, 0, std::chrono::seconds(10));
+    aged.ingest(Player("P", 90), start);
+    aged.ingest(Player("P", 5), start + std::chrono::seconds(4));
+    aged.ingest(Player("P", 60), start + std::chrono::seconds(8));
+    CHECK(levels(aged.snapshot()) == (std::vector<size_t>{60, 90}));
+    aged.expire(start + std::chrono::seconds(11));
+    CHECK(aged.windowSize() == 2);
+    CHECK(levels(aged.snapshot()) == (std::vector<size_t>{5, 60}));
+    aged.expire(start + std::chrono::seconds(30));
+    CHECK(aged.windowSize() == 0);
+    CHECK(aged.size() == 0);
+    CHECK(aged.cutoff() == 0);
+}
+
+void testWindowedAgainstModel() {
+    std::mt19937_64 rng(42);
+    const std::function<size_t(size_t)> orders[] = {
+        [&rng](size_t) { return rng() % 1000; },
+        [](size_t i) { return i; },
+        [](size_t i) { return 100000 - i; },
+        [&rng](size_t) { return rng() % 4; },
+    };
+    for (const auto &order : orders) {
+        for (const size_t r : {1, 5, 32}) {
+            const size_t window = 200;
+            Online::WindowedLeaderboard leaderboard(r, window);
+            std::vector<size_t> ingested;
+            for (size_t i = 0; i < 5000; ++i) {
+                ingested.push_back(order(i));
+                leaderboard.ingest(Player("P", ingested.back(), i));
+
+                const size_t first = ingested.size() - std::min(window, ingested.size());
+                const std::vector<size_t> expected = topLevels({ingested.begin() + first, ingested.end()}, r);
+                CHECK(levels(leaderboard.snapshot()) == expected);
+                CHECK(leaderboard.windowSize() == ingested.size() - first);
+                CHECK(leaderboard.candidateCount() <= leaderboard.windowSize());
+            }
+        }
+    }
+}
+
+void testPartitionedCutoffs() {
+    std::mt19937_64 rng(7);
+    const size_t interval = 5, partitions = 6;
+    std::vector<Player> players;
+    for (size_t i = 0; i < 3000; ++i) {
+        // Partition 0 gets twice the Players, so the partitions report at different times
+        players.emplace_back("P" + std::to_string(i), rng() % 500, i % (partitions + 1) % partitions);
+    }
+    auto partitionOf = [](const Player &player) { return player.id_; };
+
+    Online::PartitionedLeaderboard leaderboard(interval);
+    for (size_t first = 0; first < players.size(); first += 128) {
+        const size_t last = std::min(first + 128, players.size());
+        leaderboard.ingest(PlayerChunk{players.data() + first, players.data() + last}, partitionOf);
+    }
+    CHECK(leaderboard.count() == players.size());
+    const size_t seen = leaderboard.partitionCount();
+    CHECK(seen == partitions);
+    CHECK(leaderboard.cutoff(partitions + 1) == 0);
+
+    std::vector<size_t> liveCutoffs;
+    for (size_t partition = 0; partition < partitions; ++partition) {
+        liveCutoffs.push_back(leaderboard.cutoff(partition));
+    }
+
+    const Online::PartitionedRankingResult result = leaderboard.finish();
+    CHECK(result.partitions_.size() == seen);
+    CHECK(leaderboard.partitionCount() == 0);
+    for (const auto &[partition, ranking] : result.partitions_) {
+        std::vector<Player> own;
+        for (const Player &player : players) {
+            if (partitionOf(player) == partition) {
+                own.push_back(player);
+            }
+        }
+        VectorPlayerStream stream(std::move(own));
+        const RankingResult expected = Online::rankIncoming(stream, interval);
+
+        CHECK(levels(ranking.top_) == levels(expected.top_));
+        CHECK(ranking.cutoffs_ == expected.cutoffs_);
+        CHECK(ranking.top_.front().level_ == liveCutoffs[partition]);
+        CHECK(&result.at(partition) == &ranking);
+    }
+}
+} // namespace
+
+int main() {
+    const std::pair<const char *, void (*)()> tests[] = {
+        {"updatable cross-over", testUpdatableCrossOver},
+        {"updatable vs. model", testUpdatableAgainstModel},
+        {"windowed expiry", testWindowedExpiry},
+        {"windowed vs. model", testWindowedAgainstModel},
+        {"partitioned cutoffs", testPartitionedCutoffs},
+    };
+    for (const auto &[name, test] : tests) {
+        const size_t before = failures;
+        test();
+        std::printf("%-24s %s\n", name, failures == before ? "ok" : "FAILED");
+    }
+    return failures == 0 ? 0 : 1;
+}